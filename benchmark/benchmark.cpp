@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+using namespace bc::system;
+using namespace boost::filesystem;
+using namespace boost::system;
+using boost::format;
+
+#define BENCHMARK_JSON \
+    "{\"benchmark\":\"%1%\",\"unit\":\"%2%\",\"samples\":%3%," \
+    "\"units\":%4%,\"seconds\":%5$.6f,\"units_per_second\":%6$.1f," \
+    "\"ns_per_unit\":%7$.1f,\"p50_ns\":%8%,\"p99_ns\":%9%,\"max_ns\":%10%," \
+    "\"seed\":%11%,\"blocks\":%12%,\"transactions\":%13%,\"inputs\":%14%," \
+    "\"outputs\":%15%,\"reorganize_interval\":%16%," \
+    "\"reorganize_depth\":%17%}\n"
+#define BENCHMARK_CSV_HEADER \
+    "benchmark,unit,samples,units,seconds,units_per_second,ns_per_unit," \
+    "p50_ns,p99_ns,max_ns,seed,blocks,transactions,inputs,outputs," \
+    "reorganize_interval,reorganize_depth\n"
+#define BENCHMARK_CSV \
+    "%1%,%2%,%3%,%4%,%5$.6f,%6$.1f,%7$.1f,%8%,%9%,%10%,%11%,%12%,%13%," \
+    "%14%,%15%,%16%,%17%\n"
+
+// Settings.
+// ----------------------------------------------------------------------------
+
+settings::settings()
+  : directory("benchmark_store"),
+    filter(),
+    format("json"),
+    blocks(1000),
+    samples(100000),
+    threads(std::max(std::thread::hardware_concurrency(), 1u)),
+    chain()
+{
+}
+
+bool settings::parse(int argc, char** argv)
+{
+    std::map<std::string, std::function<void(const std::string&)>> options;
+
+    const auto number = [](size_t& out)
+    {
+        return [&out](const std::string& value)
+        {
+            out = static_cast<size_t>(std::stoull(value));
+        };
+    };
+
+    options["--directory"] = [this](const std::string& value)
+    {
+        directory = value;
+    };
+
+    options["--filter"] = [this](const std::string& value)
+    {
+        filter = value;
+    };
+
+    options["--format"] = [this](const std::string& value)
+    {
+        if (value != "json" && value != "csv")
+            throw std::invalid_argument(value);
+
+        format = value;
+    };
+
+    options["--seed"] = [this](const std::string& value)
+    {
+        chain.seed = std::stoull(value);
+    };
+
+    options["--blocks"] = number(blocks);
+    options["--samples"] = number(samples);
+    options["--threads"] = number(threads);
+    options["--transactions"] = number(chain.transactions);
+    options["--inputs"] = number(chain.inputs);
+    options["--outputs"] = number(chain.outputs);
+    options["--script-hash"] = number(chain.pay_script_hash);
+    options["--witness-key-hash"] = number(chain.pay_witness_key_hash);
+    options["--witness-script-hash"] = number(chain.pay_witness_script_hash);
+    options["--multisig"] = number(chain.pay_multisig);
+    options["--null-data"] = number(chain.null_data);
+    options["--reorganize-interval"] = number(chain.reorganize_interval);
+    options["--reorganize-depth"] = number(chain.reorganize_depth);
+
+    for (auto index = 1; index < argc; ++index)
+    {
+        const std::string argument(argv[index]);
+        const auto split = argument.find('=');
+        const auto it = options.find(argument.substr(0, split));
+
+        if (split == std::string::npos || it == options.end())
+            return false;
+
+        try
+        {
+            it->second(argument.substr(split + 1));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    // The script mix is in percent, and a pipeline requires a thread.
+    return chain.pay_script_hash + chain.pay_witness_key_hash +
+        chain.pay_witness_script_hash + chain.pay_multisig +
+        chain.null_data <= 100 && threads != 0 && samples != 0;
+}
+
+// Recorder.
+// ----------------------------------------------------------------------------
+
+recorder::recorder(const std::string& name, const std::string& unit)
+  : name_(name), unit_(unit), units_(0), elapsed_(0)
+{
+}
+
+void recorder::add(size_t units, const nanoseconds& elapsed)
+{
+    if (units == 0)
+        return;
+
+    units_ += units;
+    elapsed_ += elapsed;
+    per_unit_.push_back(static_cast<double>(elapsed.count()) / units);
+}
+
+result recorder::summarize() const
+{
+    auto sorted = per_unit_;
+    std::sort(sorted.begin(), sorted.end());
+
+    // The value at or below which the fraction of samples fall.
+    const auto percentile = [&sorted](double fraction)
+    {
+        if (sorted.empty())
+            return nanoseconds(0);
+
+        const auto rank = static_cast<size_t>(std::ceil(fraction *
+            sorted.size()));
+        const auto index = std::min(std::max<size_t>(rank, 1),
+            sorted.size()) - 1;
+        return nanoseconds(static_cast<int64_t>(std::llround(sorted[index])));
+    };
+
+    return
+    {
+        name_,
+        unit_,
+        per_unit_.size(),
+        units_,
+        elapsed_,
+        percentile(0.5),
+        percentile(0.99),
+        percentile(1.0)
+    };
+}
+
+// Reporter.
+// ----------------------------------------------------------------------------
+
+reporter::reporter(std::ostream& stream, const settings& settings)
+  : stream_(stream), settings_(settings), header_(false)
+{
+}
+
+void reporter::report(const result& result)
+{
+    const auto json = settings_.format == "json";
+
+    if (!json && !header_)
+        stream_ << BENCHMARK_CSV_HEADER;
+
+    header_ = true;
+    const auto seconds = result.elapsed.count() / 1e9;
+    const auto units = static_cast<double>(result.units);
+    const auto& chain = settings_.chain;
+
+    stream_ << format(json ? BENCHMARK_JSON : BENCHMARK_CSV) % result.name %
+        result.unit % result.samples % result.units % seconds %
+        (seconds > 0 ? units / seconds : 0.0) %
+        (units > 0 ? result.elapsed.count() / units : 0.0) %
+        result.p50.count() % result.p99.count() % result.maximum.count() %
+        chain.seed % settings_.blocks % chain.transactions % chain.inputs %
+        chain.outputs % chain.reorganize_interval % chain.reorganize_depth;
+
+    stream_.flush();
+}
+
+// Utilities.
+// ----------------------------------------------------------------------------
+
+bool clear_directory(const path& directory)
+{
+    error_code ec;
+    remove_all(directory, ec);
+    return !ec && create_directories(directory, ec) && !ec;
+}
+
+bool create_file(const path& file)
+{
+    bc::system::ofstream stream(file.string());
+
+    if (!stream.good())
+        return false;
+
+    stream.put('x');
+    return true;
+}
+
+// Hash tables are sized for a load factor of one half.
+bc::database::settings store_settings(const settings& settings,
+    const path& directory)
+{
+    const auto transactions = settings.blocks *
+        (settings.chain.transactions + 1);
+    const auto outputs = transactions * std::max<size_t>(
+        settings.chain.outputs, 1);
+    const auto buckets = [](size_t elements)
+    {
+        return static_cast<uint32_t>(std::min<size_t>(
+            std::max<size_t>(2 * elements, 1000), max_uint32));
+    };
+
+    bc::database::settings out;
+    out.directory = directory;
+    out.flush_writes = false;
+    out.file_growth_rate = 50;
+    out.block_table_buckets = buckets(settings.blocks);
+    out.transaction_table_buckets = buckets(transactions);
+    out.payment_table_buckets = buckets(outputs);
+    out.utxo_table_buckets = buckets(outputs);
+    out.neutrino_filter_table_buckets = buckets(settings.blocks);
+    return out;
+}
+
+} // namespace benchmark
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_BENCHMARK_BENCHMARK_HPP
+#define LIBBITCOIN_DATABASE_BENCHMARK_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "generator.hpp"
+
+namespace benchmark {
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::chrono::nanoseconds nanoseconds;
+
+/// Command line settings.
+struct settings
+{
+    settings();
+
+    /// Parse --name=value arguments, false if any is not recognized.
+    bool parse(int argc, char** argv);
+
+    boost::filesystem::path directory;
+    std::string filter;
+    std::string format;
+    size_t blocks;
+    size_t samples;
+    size_t threads;
+    generator_settings chain;
+};
+
+/// The result of one benchmark, percentiles are of time per unit of work.
+struct result
+{
+    std::string name;
+    std::string unit;
+    size_t samples;
+    uint64_t units;
+    nanoseconds elapsed;
+    nanoseconds p50;
+    nanoseconds p99;
+    nanoseconds maximum;
+};
+
+/// This class is not thread safe.
+/// Collects timed samples, each of one or more units of work.
+class recorder
+{
+public:
+    recorder(const std::string& name, const std::string& unit);
+
+    /// Time the function as one sample of the given units of work.
+    template <typename Function>
+    void sample(size_t units, Function&& function)
+    {
+        const auto start = clock_type::now();
+        function();
+        add(units, std::chrono::duration_cast<nanoseconds>(
+            clock_type::now() - start));
+    }
+
+    /// Add a sample timed by the caller.
+    void add(size_t units, const nanoseconds& elapsed);
+
+    /// Summarize the samples.
+    result summarize() const;
+
+private:
+    const std::string name_;
+    const std::string unit_;
+    uint64_t units_;
+    nanoseconds elapsed_;
+    std::vector<double> per_unit_;
+};
+
+/// This class is not thread safe.
+/// Writes results as json lines or csv, each with the run settings.
+class reporter
+{
+public:
+    reporter(std::ostream& stream, const settings& settings);
+
+    void report(const result& result);
+
+private:
+    std::ostream& stream_;
+    const settings& settings_;
+    bool header_;
+};
+
+/// A benchmark returns false if the store fails, results are reported.
+typedef std::function<bool(const settings&, reporter&)> runner;
+
+struct definition
+{
+    std::string name;
+    runner run;
+};
+
+typedef std::vector<definition> benchmarks;
+
+/// Clear and create a directory for the benchmark store.
+bool clear_directory(const boost::filesystem::path& directory);
+
+/// Create a file with one byte, as required to map it.
+bool create_file(const boost::filesystem::path& file);
+
+/// Database settings sized for the synthetic chain.
+bc::database::settings store_settings(const settings& settings,
+    const boost::filesystem::path& directory);
+
+void add_primitives(benchmarks& out);
+void add_databases(benchmarks& out);
+void add_data_base(benchmarks& out);
+
+} // namespace benchmark
+
+#endif
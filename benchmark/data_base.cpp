@@ -0,0 +1,283 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace boost::filesystem;
+
+// Headers per reorganization when candidating a chain for update.
+static constexpr size_t header_batch_size = 1000;
+
+// A store created with the genesis block, without optional indexes.
+// The store retains a reference to the configuration, which must outlive it.
+static std::shared_ptr<data_base> create_store(
+    const bc::database::settings& configuration, const block& genesis)
+{
+    if (!clear_directory(configuration.directory))
+        return nullptr;
+
+    const auto database = std::make_shared<data_base>(configuration, false,
+        false);
+
+    return database->create(genesis) ? database : nullptr;
+}
+
+// Headers carry the median time past (and no existence) to the store.
+static header_const_ptr_list_const_ptr to_headers(
+    const block_const_ptr_list& blocks, size_t first, size_t last)
+{
+    const auto headers = std::make_shared<header_const_ptr_list>();
+    headers->reserve(last - first);
+
+    for (auto index = first; index < last; ++index)
+    {
+        const auto& header = blocks[index]->header();
+        const auto next = std::make_shared<message::header>(header);
+        next->metadata.median_time_past = header.metadata.median_time_past;
+        next->metadata.exists = false;
+        headers->push_back(next);
+    }
+
+    return headers;
+}
+
+// data_base::push of each block of the chain, as by initchain.
+static bool data_base_push(const settings& settings, reporter& out)
+{
+    const bc::system::settings bitcoin_settings(config::settings::mainnet);
+    const auto& genesis = bitcoin_settings.genesis_block;
+    const auto configuration = store_settings(settings,
+        settings.directory / "push");
+    const auto database = create_store(configuration, genesis);
+
+    if (!database)
+        return false;
+
+    auto shape = settings.chain;
+    shape.reorganize_interval = 0;
+    chain_generator generator(shape, genesis);
+    const auto blocks = generator.extend(settings.blocks);
+
+    auto success = true;
+    recorder pushing("data_base.push", "blocks");
+
+    for (size_t index = 0; index < blocks.size() && success; ++index)
+    {
+        const auto& block = *blocks[index];
+        const auto time = block.header().metadata.median_time_past;
+
+        pushing.sample(1, [&]()
+        {
+            success = !database->push(block, index + 1, time);
+        });
+    }
+
+    out.report(pushing.summarize());
+    return success && database->close();
+}
+
+// The organizer sequence of each branch of the chain: header reorganization,
+// update, candidate and block reorganization. Branches below the top are
+// reported apart from extensions of the top.
+static bool data_base_reorganize(const settings& settings, reporter& out)
+{
+    const bc::system::settings bitcoin_settings(config::settings::mainnet);
+    const auto& genesis = bitcoin_settings.genesis_block;
+    const auto configuration = store_settings(settings,
+        settings.directory / "reorganize");
+    const auto database = create_store(configuration, genesis);
+
+    if (!database)
+        return false;
+
+    chain_generator generator(settings.chain, genesis);
+    recorder headers("data_base.reorganize.headers", "headers");
+    recorder updating("data_base.update", "blocks");
+    recorder candidating("data_base.candidate", "blocks");
+    recorder extending("data_base.reorganize.extend", "blocks");
+    recorder forking("data_base.reorganize.fork", "blocks");
+    auto success = true;
+
+    while (generator.top_height() < settings.blocks && success)
+    {
+        const auto branch = generator.next();
+        const auto& blocks = branch.blocks;
+        const config::checkpoint fork(branch.fork_hash, branch.fork_height);
+        const auto incoming_headers = to_headers(blocks, 0, blocks.size());
+        const auto outgoing_headers =
+            std::make_shared<header_const_ptr_list>();
+
+        headers.sample(blocks.size(), [&]()
+        {
+            success &= !database->reorganize(fork, incoming_headers,
+                outgoing_headers);
+        });
+
+        for (size_t index = 0; index < blocks.size() && success; ++index)
+        {
+            const auto& block = *blocks[index];
+            const auto height = branch.fork_height + index + 1;
+
+            updating.sample(1, [&]()
+            {
+                success &= !database->update(block, height);
+            });
+
+            candidating.sample(1, [&]()
+            {
+                success &= !database->candidate(block);
+            });
+        }
+
+        if (!success)
+            break;
+
+        const auto incoming = std::make_shared<const block_const_ptr_list>(
+            blocks);
+        const auto outgoing = std::make_shared<block_const_ptr_list>();
+        const auto start = clock_type::now();
+        success &= !database->reorganize(fork, incoming, outgoing);
+        const auto elapsed = std::chrono::duration_cast<nanoseconds>(
+            clock_type::now() - start);
+
+        if (outgoing->empty())
+            extending.add(incoming->size(), elapsed);
+        else
+            forking.add(incoming->size() + outgoing->size(), elapsed);
+    }
+
+    out.report(headers.summarize());
+    out.report(updating.summarize());
+    out.report(candidating.summarize());
+    out.report(extending.summarize());
+    out.report(forking.summarize());
+    return success && database->close();
+}
+
+// update_pipeline throughput by thread count, doubling to the maximum.
+// Headers are candidated first, then blocks are updated in parallel and
+// validated (as invalidate) in height order.
+static bool update_pipeline_threads(const settings& settings, reporter& out)
+{
+    const bc::system::settings bitcoin_settings(config::settings::mainnet);
+    const auto& genesis = bitcoin_settings.genesis_block;
+    auto shape = settings.chain;
+    shape.reorganize_interval = 0;
+
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads < settings.threads; threads *= 2)
+        counts.push_back(threads);
+
+    counts.push_back(settings.threads);
+
+    for (const auto threads: counts)
+    {
+        const auto name = "update_pipeline.threads_" + std::to_string(threads);
+        const auto configuration = store_settings(settings,
+            settings.directory / "update_pipeline");
+        const auto database = create_store(configuration, genesis);
+
+        if (!database)
+            return false;
+
+        // Txs are linked to the store on update, so the chain is not reused.
+        chain_generator generator(shape, genesis);
+        const auto blocks = generator.extend(settings.blocks);
+        auto fork = config::checkpoint(genesis.hash(), 0);
+
+        for (size_t first = 0; first < blocks.size();
+            first += header_batch_size)
+        {
+            const auto last = std::min(first + header_batch_size,
+                blocks.size());
+            const auto outgoing = std::make_shared<header_const_ptr_list>();
+
+            if (database->reorganize(fork, to_headers(blocks, first, last),
+                outgoing))
+                return false;
+
+            fork = config::checkpoint(blocks[last - 1]->hash(), last);
+        }
+
+        auto success = true;
+        size_t completed = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        const auto complete = [&](const code& ec, block_const_ptr block,
+            size_t)
+        {
+            const auto valid = !ec &&
+                !database->invalidate(block->header(), error::success);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                success &= valid;
+                ++completed;
+            }
+
+            condition.notify_one();
+        };
+
+        recorder updating(name, "blocks");
+        updating.sample(blocks.size(), [&]()
+        {
+            update_pipeline pipeline(*database, 1, threads, complete);
+
+            for (size_t index = 0; index < blocks.size(); ++index)
+                pipeline.enqueue(blocks[index], index + 1);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]()
+            {
+                return completed == blocks.size();
+            });
+        });
+
+        out.report(updating.summarize());
+
+        if (!success || !database->close())
+            return false;
+    }
+
+    return true;
+}
+
+void add_data_base(benchmarks& out)
+{
+    out.push_back({ "data_base.push", data_base_push });
+    out.push_back({ "data_base.reorganize", data_base_reorganize });
+    out.push_back({ "update_pipeline", update_pipeline_threads });
+}
+
+} // namespace benchmark
@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace boost::filesystem;
+
+// The chain without reorganization, as tables are written in height order.
+static block_const_ptr_list make_chain(const settings& settings)
+{
+    auto shape = settings.chain;
+    shape.reorganize_interval = 0;
+
+    const bc::system::settings bitcoin_settings(config::settings::mainnet);
+    chain_generator generator(shape, bitcoin_settings.genesis_block);
+    return generator.extend(settings.blocks);
+}
+
+static size_t count_transactions(const block_const_ptr_list& blocks)
+{
+    size_t count = 0;
+
+    for (const auto& block: blocks)
+        count += block->transactions().size();
+
+    return count;
+}
+
+// transaction_database::store, confirm and get_output, stored and confirmed
+// by block in height order, and outputs found in random order.
+static bool transaction_database_store_confirm(const settings& settings,
+    reporter& out)
+{
+    const auto directory = settings.directory / "transaction_database";
+    const auto table = directory / "transaction_table";
+    const auto witness = directory / "witness_table";
+    const auto utxo = directory / "utxo_table";
+
+    if (!clear_directory(directory) || !create_file(table) ||
+        !create_file(witness) || !create_file(utxo))
+        return false;
+
+    const auto blocks = make_chain(settings);
+    const auto configuration = store_settings(settings, directory);
+    transaction_database database(table, witness, utxo, 1, 1, 1,
+        configuration.transaction_table_buckets,
+        configuration.utxo_table_buckets, configuration.file_growth_rate, 0,
+        0);
+
+    if (!database.create())
+        return false;
+
+    auto success = true;
+    recorder storing("transaction_database.store", "transactions");
+
+    for (const auto& block: blocks)
+    {
+        storing.sample(block->transactions().size(), [&]()
+        {
+            success &= database.store(block->transactions());
+            database.commit();
+        });
+    }
+
+    out.report(storing.summarize());
+    recorder confirming("transaction_database.confirm", "transactions");
+
+    for (size_t index = 0; index < blocks.size() && success; ++index)
+    {
+        const auto& block = *blocks[index];
+        const auto time = block.header().metadata.median_time_past;
+
+        confirming.sample(block.transactions().size(), [&]()
+        {
+            success &= database.confirm(block, index + 1, time);
+            database.commit();
+        });
+    }
+
+    out.report(confirming.summarize());
+
+    // Prevouts of the chain, each is a confirmed output.
+    std::vector<output_point> points;
+
+    for (const auto& block: blocks)
+        for (const auto& tx: block->transactions())
+            for (const auto& input: tx.inputs())
+                if (!input.previous_output().is_null())
+                    points.push_back(input.previous_output());
+
+    std::mt19937_64 random(settings.chain.seed);
+    std::shuffle(points.begin(), points.end(), random);
+    points.resize(std::min(points.size(), settings.samples));
+
+    size_t found = 0;
+    recorder getting("transaction_database.get_output", "outputs");
+
+    for (const auto& point: points)
+    {
+        getting.sample(1, [&]()
+        {
+            if (database.get_output(point, blocks.size()))
+                ++found;
+        });
+    }
+
+    out.report(getting.summarize());
+    return success && found == points.size() && database.close();
+}
+
+// payment_database::catalog and get, cataloged by block in height order, and
+// payments of output scripts found in random order.
+static bool payment_database_catalog_get(const settings& settings,
+    reporter& out)
+{
+    const auto directory = settings.directory / "payment_database";
+    const auto table = directory / "payment_table";
+    const auto rows = directory / "payment_rows";
+
+    if (!clear_directory(directory) || !create_file(table) ||
+        !create_file(rows))
+        return false;
+
+    const auto blocks = make_chain(settings);
+    const auto configuration = store_settings(settings, directory);
+    payment_database database(table, rows, 1, 1,
+        configuration.payment_table_buckets, configuration.file_growth_rate);
+
+    if (!database.create())
+        return false;
+
+    // Cataloging requires tx links, which are here simply positions.
+    file_offset link = 0;
+
+    for (const auto& block: blocks)
+        for (const auto& tx: block->transactions())
+            tx.metadata.link = ++link;
+
+    recorder cataloging("payment_database.catalog", "transactions");
+
+    for (const auto& block: blocks)
+    {
+        cataloging.sample(block->transactions().size(), [&]()
+        {
+            for (const auto& tx: block->transactions())
+                database.catalog(tx);
+
+            database.commit();
+        });
+    }
+
+    out.report(cataloging.summarize());
+
+    hash_list keys;
+    keys.reserve(count_transactions(blocks));
+
+    for (const auto& block: blocks)
+        for (const auto& tx: block->transactions())
+            keys.push_back(tx.outputs().front().script().to_payments_key());
+
+    std::mt19937_64 random(settings.chain.seed);
+    std::shuffle(keys.begin(), keys.end(), random);
+    keys.resize(std::min(keys.size(), settings.samples));
+
+    size_t found = 0;
+    recorder getting("payment_database.get", "payments");
+
+    for (const auto& key: keys)
+    {
+        size_t payments = 0;
+        const auto start = clock_type::now();
+        const auto result = database.get(key);
+
+        for (auto it = result.begin(); it != result.end(); ++it)
+            ++payments;
+
+        getting.add(std::max<size_t>(payments, 1),
+            std::chrono::duration_cast<nanoseconds>(clock_type::now() -
+                start));
+
+        if (payments != 0)
+            ++found;
+    }
+
+    out.report(getting.summarize());
+    return found == keys.size() && database.close();
+}
+
+void add_databases(benchmarks& out)
+{
+    out.push_back({ "transaction_database",
+        transaction_database_store_confirm });
+    out.push_back({ "payment_database", payment_database_catalog_get });
+}
+
+} // namespace benchmark
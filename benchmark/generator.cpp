@@ -0,0 +1,436 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "generator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace bc::system::machine;
+
+// Target spacing of generated timestamps.
+static constexpr uint32_t spacing_seconds = 600;
+
+// Median time past window (see chain_state).
+static constexpr size_t median_time_past_interval = 11;
+
+// The value of each coinbase, split among its outputs.
+static constexpr uint64_t coinbase_value = 50 * uint64_t(100000000);
+
+// Random stand-ins for an endorsement and a compressed public key.
+static constexpr size_t endorsement_size = 72;
+static constexpr size_t public_key_size = 33;
+
+generator_settings::generator_settings()
+  : seed(42),
+    transactions(100),
+    inputs(2),
+    outputs(2),
+    pay_script_hash(15),
+    pay_witness_key_hash(25),
+    pay_witness_script_hash(5),
+    pay_multisig(2),
+    null_data(3),
+    reorganize_interval(100),
+    reorganize_depth(2)
+{
+}
+
+// Coinbase outputs become spendable once below any reorganization, so that
+// a reorganization never discards a coinbase output that has been spent.
+chain_generator::chain_generator(const generator_settings& settings,
+    const block& genesis)
+  : settings_(settings),
+    genesis_time_(genesis.header().timestamp()),
+    delay_(settings.reorganize_depth + 1),
+    random_(settings.seed),
+    generated_(0),
+    branches_(0),
+    hashes_{ genesis.hash() }
+{
+}
+
+size_t chain_generator::top_height() const
+{
+    return hashes_.size() - 1;
+}
+
+chain_generator::branch chain_generator::next()
+{
+    const auto interval = settings_.reorganize_interval;
+    const auto depth = settings_.reorganize_depth;
+
+    if (interval != 0 && depth != 0 && recent_.size() == depth &&
+        ++generated_ % interval == 0)
+        return reorganize();
+
+    const auto fork_height = top_height();
+    const auto fork_hash = hashes_.back();
+    return { fork_height, fork_hash, { append(make_transactions()) } };
+}
+
+block_const_ptr_list chain_generator::extend(size_t count)
+{
+    block_const_ptr_list blocks;
+    blocks.reserve(count);
+
+    for (size_t block = 0; block < count; ++block)
+        blocks.push_back(append(make_transactions()));
+
+    return blocks;
+}
+
+// private
+chain_generator::branch chain_generator::reorganize()
+{
+    const auto depth = settings_.reorganize_depth;
+    const auto fork_height = top_height() - depth;
+    branch out{ fork_height, hashes_[fork_height], {} };
+    out.blocks.reserve(depth + 1);
+
+    const block_const_ptr_list outgoing(recent_.begin(), recent_.end());
+    hashes_.resize(fork_height + 1);
+    recent_.clear();
+    ++branches_;
+
+    // Outgoing coinbase outputs are not yet spendable, so are discarded.
+    while (!maturing_.empty() && maturing_.back().first > fork_height)
+        maturing_.pop_back();
+
+    // Outgoing txs are confirmed again, in order, so the pool is unchanged.
+    for (const auto& block: outgoing)
+    {
+        const auto& txs = block->transactions();
+        out.blocks.push_back(append({ std::next(txs.begin()), txs.end() }));
+    }
+
+    out.blocks.push_back(append(make_transactions()));
+    return out;
+}
+
+// private
+// A uniformly distributed count about the mean.
+size_t chain_generator::draw(size_t mean)
+{
+    if (mean == 0)
+        return 0;
+
+    const auto minimum = std::max<size_t>(mean / 2, 1);
+    const auto maximum = mean + mean / 2;
+    return minimum + random_() % (maximum - minimum + 1);
+}
+
+// private
+void chain_generator::fill(uint8_t* data, size_t size)
+{
+    for (size_t index = 0; index < size; ++index)
+        data[index] = static_cast<uint8_t>(random_());
+}
+
+// private
+data_chunk chain_generator::random_data(size_t size)
+{
+    data_chunk data(size);
+    fill(data.data(), size);
+    return data;
+}
+
+// private
+output chain_generator::make_output(uint64_t value, kind& type)
+{
+    short_hash short_digest;
+    hash_digest digest;
+    fill(short_digest.data(), short_digest.size());
+    fill(digest.data(), digest.size());
+
+    auto percent = static_cast<size_t>(random_() % 100);
+
+    if (percent < settings_.pay_script_hash)
+    {
+        type = kind::script_hash;
+        return { value, script::to_pay_script_hash_pattern(short_digest) };
+    }
+
+    percent -= settings_.pay_script_hash;
+
+    if (percent < settings_.pay_witness_key_hash)
+    {
+        type = kind::witness_key_hash;
+        return { value, operation::list
+        {
+            { opcode::push_size_0 },
+            { to_chunk(short_digest) }
+        } };
+    }
+
+    percent -= settings_.pay_witness_key_hash;
+
+    if (percent < settings_.pay_witness_script_hash)
+    {
+        type = kind::witness_script_hash;
+        return { value, operation::list
+        {
+            { opcode::push_size_0 },
+            { to_chunk(digest) }
+        } };
+    }
+
+    percent -= settings_.pay_witness_script_hash;
+
+    if (percent < settings_.pay_multisig)
+    {
+        auto key1 = random_data(public_key_size);
+        auto key2 = random_data(public_key_size);
+        key1.front() = key2.front() = 0x02;
+
+        type = kind::multisig;
+        return { value, operation::list
+        {
+            { opcode::push_positive_1 },
+            { std::move(key1) },
+            { std::move(key2) },
+            { opcode::push_positive_2 },
+            { opcode::checkmultisig }
+        } };
+    }
+
+    percent -= settings_.pay_multisig;
+
+    if (percent < settings_.null_data)
+    {
+        type = kind::null_data;
+        return { 0, script::to_null_data_pattern(to_chunk(digest)) };
+    }
+
+    type = kind::key_hash;
+    return { value, script::to_pay_key_hash_pattern(short_digest) };
+}
+
+// private
+// The input script and witness match the form of the prevout script.
+input chain_generator::make_input(const spendable& prevout)
+{
+    auto previous = prevout.point;
+    const auto sequence = max_input_sequence;
+
+    switch (prevout.type)
+    {
+        case kind::witness_key_hash:
+        case kind::witness_script_hash:
+        {
+            input segregated(std::move(previous), script{}, sequence);
+            segregated.set_witness(witness(data_stack
+            {
+                random_data(endorsement_size),
+                random_data(prevout.type == kind::witness_key_hash ?
+                    public_key_size : endorsement_size)
+            }));
+
+            return segregated;
+        }
+
+        case kind::multisig:
+        {
+            return { std::move(previous), operation::list
+            {
+                { opcode::push_size_0 },
+                { random_data(endorsement_size) }
+            }, sequence };
+        }
+
+        default:
+        {
+            return { std::move(previous), operation::list
+            {
+                { random_data(endorsement_size) },
+                { random_data(prevout.type == kind::key_hash ?
+                    public_key_size : endorsement_size) }
+            }, sequence };
+        }
+    }
+}
+
+// private
+// The height and branch make each coinbase (and so each block) unique.
+transaction chain_generator::make_coinbase(size_t height)
+{
+    const auto count = std::max<size_t>(draw(settings_.outputs), 1);
+    const auto value = coinbase_value / count;
+
+    input::list inputs
+    {
+        {
+            { null_hash, point::null_index },
+            operation::list
+            {
+                { to_chunk(to_little_endian(static_cast<uint64_t>(height))) },
+                { to_chunk(to_little_endian(branches_)) }
+            },
+            max_input_sequence
+        }
+    };
+
+    // Coinbase outputs always pay to key hash.
+    output::list outputs;
+    outputs.reserve(count);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        short_hash short_digest;
+        fill(short_digest.data(), short_digest.size());
+        outputs.emplace_back(value,
+            script::to_pay_key_hash_pattern(short_digest));
+    }
+
+    return { 1, 0, std::move(inputs), std::move(outputs) };
+}
+
+// private
+// Txs spend random prevouts from the pool, and outputs of earlier txs in the
+// block, as they are added to the pool when the tx is made.
+transaction::list chain_generator::make_transactions()
+{
+    const auto count = draw(settings_.transactions);
+    transaction::list txs;
+    txs.reserve(count);
+
+    for (size_t tx = 0; tx < count && !pool_.empty(); ++tx)
+    {
+        const auto fan_in = std::min(std::max<size_t>(
+            draw(settings_.inputs), 1), pool_.size());
+
+        spendables spent;
+        spent.reserve(fan_in);
+        uint64_t value = 0;
+
+        for (size_t index = 0; index < fan_in; ++index)
+        {
+            const auto position = random_() % pool_.size();
+            std::swap(pool_[position], pool_.back());
+            spent.push_back(std::move(pool_.back()));
+            pool_.pop_back();
+            value += spent.back().output.value();
+        }
+
+        input::list inputs;
+        inputs.reserve(fan_in);
+
+        for (const auto& prevout: spent)
+            inputs.push_back(make_input(prevout));
+
+        const auto fan_out = std::max<size_t>(draw(settings_.outputs), 1);
+        std::vector<kind> types(fan_out);
+        output::list outputs;
+        outputs.reserve(fan_out);
+
+        for (size_t index = 0; index < fan_out; ++index)
+            outputs.push_back(make_output(value / fan_out, types[index]));
+
+        txs.emplace_back(1, 0, std::move(inputs), std::move(outputs));
+
+        // Populate prevouts as validation does, required for indexing.
+        for (size_t index = 0; index < fan_in; ++index)
+            txs.back().inputs()[index].previous_output().metadata.cache =
+                spent[index].output;
+
+        add_outputs(txs.back(), types, pool_);
+    }
+
+    return txs;
+}
+
+// private
+void chain_generator::add_outputs(const transaction& tx,
+    const std::vector<kind>& types, spendables& out)
+{
+    const auto hash = tx.hash();
+    const auto& outputs = tx.outputs();
+
+    for (uint32_t index = 0; index < outputs.size(); ++index)
+        if (types[index] != kind::null_data)
+            out.push_back({ { hash, index }, outputs[index], types[index] });
+}
+
+// private
+block_const_ptr chain_generator::append(transaction::list&& transactions)
+{
+    const auto height = hashes_.size();
+
+    // Coinbase outputs of the block height below delay become spendable.
+    while (!maturing_.empty() && maturing_.front().first + delay_ <= height)
+    {
+        auto& released = maturing_.front().second;
+        std::move(released.begin(), released.end(),
+            std::back_inserter(pool_));
+        maturing_.pop_front();
+    }
+
+    auto coinbase = make_coinbase(height);
+    maturing_.emplace_back(height, spendables{});
+    add_outputs(coinbase, std::vector<kind>(coinbase.outputs().size(),
+        kind::key_hash), maturing_.back().second);
+
+    transaction::list txs;
+    txs.reserve(transactions.size() + 1);
+    txs.push_back(std::move(coinbase));
+    std::move(transactions.begin(), transactions.end(),
+        std::back_inserter(txs));
+
+    const auto timestamp = static_cast<uint32_t>(genesis_time_ +
+        spacing_seconds * height);
+
+    chain::block block({}, std::move(txs));
+    block.set_header(
+    {
+        1,
+        hashes_.back(),
+        block.generate_merkle_root(),
+        timestamp,
+        0x207fffff,
+        branches_
+    });
+
+    // Timestamps increase with height, so the median is the middle one.
+    const auto window = std::min(height, median_time_past_interval);
+    block.header().metadata.median_time_past = static_cast<uint32_t>(
+        genesis_time_ + spacing_seconds *
+        (height - window + window / 2));
+
+    const auto result = std::make_shared<const message::block>(
+        std::move(block));
+
+    hashes_.push_back(result->hash());
+    recent_.push_back(result);
+
+    if (recent_.size() > settings_.reorganize_depth)
+        recent_.pop_front();
+
+    return result;
+}
+
+} // namespace benchmark
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_BENCHMARK_GENERATOR_HPP
+#define LIBBITCOIN_DATABASE_BENCHMARK_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+/// The shape of a synthetic chain, counts per block and per tx are means.
+struct generator_settings
+{
+    generator_settings();
+
+    uint64_t seed;
+    size_t transactions;
+    size_t inputs;
+    size_t outputs;
+
+    /// Output script mix in percent, the remainder pays to key hash.
+    size_t pay_script_hash;
+    size_t pay_witness_key_hash;
+    size_t pay_witness_script_hash;
+    size_t pay_multisig;
+    size_t null_data;
+
+    /// A reorganization every interval blocks (zero disables), of depth.
+    size_t reorganize_interval;
+    size_t reorganize_depth;
+};
+
+/// This class is not thread safe.
+/// Generates a deterministic chain of structurally valid blocks on genesis.
+/// Scripts and signatures are random data, as the store does not verify
+/// them. Prevout metadata is populated, as by validation, for indexing.
+class chain_generator
+{
+public:
+    /// Blocks to push onto the fork point, replacing any above it.
+    struct branch
+    {
+        size_t fork_height;
+        bc::system::hash_digest fork_hash;
+        bc::system::block_const_ptr_list blocks;
+    };
+
+    chain_generator(const generator_settings& settings,
+        const bc::system::chain::block& genesis);
+
+    /// One block on the top, or at each interval a reorganization that
+    /// replaces the top depth blocks with depth + 1 blocks carrying the same
+    /// transactions (under new coinbases).
+    branch next();
+
+    /// The next count blocks on the top, without reorganization.
+    bc::system::block_const_ptr_list extend(size_t count);
+
+    /// The height of the generated top block.
+    size_t top_height() const;
+
+private:
+    enum class kind
+    {
+        key_hash,
+        script_hash,
+        witness_key_hash,
+        witness_script_hash,
+        multisig,
+        null_data
+    };
+
+    struct spendable
+    {
+        bc::system::chain::output_point point;
+        bc::system::chain::output output;
+        kind type;
+    };
+
+    typedef std::vector<spendable> spendables;
+    typedef std::pair<size_t, spendables> maturing;
+
+    size_t draw(size_t mean);
+    void fill(uint8_t* data, size_t size);
+    bc::system::data_chunk random_data(size_t size);
+
+    bc::system::chain::output make_output(uint64_t value, kind& type);
+    bc::system::chain::input make_input(const spendable& prevout);
+    bc::system::chain::transaction make_coinbase(size_t height);
+    bc::system::chain::transaction::list make_transactions();
+    bc::system::block_const_ptr append(
+        bc::system::chain::transaction::list&& transactions);
+    branch reorganize();
+
+    static void add_outputs(const bc::system::chain::transaction& tx,
+        const std::vector<kind>& types, spendables& out);
+
+    const generator_settings settings_;
+    const uint32_t genesis_time_;
+    const size_t delay_;
+    std::mt19937_64 random_;
+    size_t generated_;
+    uint32_t branches_;
+
+    // Block hashes of the current chain by height.
+    bc::system::hash_list hashes_;
+
+    // The top blocks of the current chain, at most reorganize_depth.
+    std::deque<bc::system::block_const_ptr> recent_;
+
+    // Outputs available to spend, and coinbase outputs not yet available.
+    spendables pool_;
+    std::deque<maturing> maturing_;
+};
+
+} // namespace benchmark
+
+#endif
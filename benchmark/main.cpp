@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "benchmark.hpp"
+
+#define BS_BENCHMARK_USAGE \
+    "Usage: libbitcoin-database-benchmark [--name=value]...\n" \
+    "  --directory=<path>           scratch store (benchmark_store)\n" \
+    "  --filter=<prefix>            benchmarks to run (all)\n" \
+    "  --format=<json|csv>          output format (json)\n" \
+    "  --blocks=<count>             synthetic chain height (1000)\n" \
+    "  --samples=<count>            lookups per micro-benchmark (100000)\n" \
+    "  --threads=<count>            maximum pipeline threads (cores)\n" \
+    "  --seed=<number>              chain generator seed (42)\n" \
+    "  --transactions=<count>       mean txs per block (100)\n" \
+    "  --inputs=<count>             mean inputs per tx (2)\n" \
+    "  --outputs=<count>            mean outputs per tx (2)\n" \
+    "  --script-hash=<percent>      outputs paying to script hash (15)\n" \
+    "  --witness-key-hash=<percent> outputs paying to witness key (25)\n" \
+    "  --witness-script-hash=<percent> outputs to witness script (5)\n" \
+    "  --multisig=<percent>         bare multisig outputs (2)\n" \
+    "  --null-data=<percent>        null data outputs (3)\n" \
+    "  --reorganize-interval=<count> blocks per reorganization (100)\n" \
+    "  --reorganize-depth=<count>   blocks replaced by each (2)\n"
+#define BS_BENCHMARK_FAIL \
+    "Benchmark %1% failed.\n"
+
+using namespace bc;
+using namespace boost::filesystem;
+using boost::format;
+
+// Run the benchmarks matching the filter, writing results to stdout.
+int main(int argc, char** argv)
+{
+    benchmark::settings settings;
+
+    if (!settings.parse(argc, argv))
+    {
+        std::cerr << BS_BENCHMARK_USAGE;
+        return -1;
+    }
+
+    benchmark::benchmarks benchmarks;
+    benchmark::add_primitives(benchmarks);
+    benchmark::add_databases(benchmarks);
+    benchmark::add_data_base(benchmarks);
+
+    benchmark::reporter reporter(std::cout, settings);
+    auto result = 0;
+
+    for (const auto& entry: benchmarks)
+    {
+        if (entry.name.compare(0, settings.filter.size(),
+            settings.filter) != 0)
+            continue;
+
+        if (!entry.run(settings, reporter))
+        {
+            std::cerr << format(BS_BENCHMARK_FAIL) % entry.name;
+            result = -1;
+        }
+    }
+
+    boost::system::error_code ec;
+    remove_all(settings.directory, ec);
+    return result;
+}
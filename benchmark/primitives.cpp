@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace benchmark {
+
+using namespace bc::database;
+using namespace bc::system;
+using namespace boost::filesystem;
+
+typedef hash_table<slab_manager<file_offset>, array_index, file_offset,
+    hash_digest> slab_map;
+
+// Calls are timed in batches, so that clock overhead is not measured.
+static constexpr size_t batch_size = 100;
+
+// The size of a typical (one input, two output) transaction.
+static constexpr size_t value_size = 250;
+
+// Keys are random, with the distribution of tx hashes.
+static hash_list make_keys(size_t count, std::mt19937_64& random)
+{
+    hash_list keys(count);
+
+    for (auto& key: keys)
+        for (auto& byte: key)
+            byte = static_cast<uint8_t>(random());
+
+    return keys;
+}
+
+// A random order of the first count positions.
+static std::vector<size_t> make_order(size_t count, std::mt19937_64& random)
+{
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), random);
+    return order;
+}
+
+// Time the function over [first, last) of count positions in batches.
+template <typename Function>
+static void sample_batches(recorder& samples, size_t count,
+    Function&& function)
+{
+    for (size_t first = 0; first < count; first += batch_size)
+    {
+        const auto last = std::min(first + batch_size, count);
+        samples.sample(last - first, [&]()
+        {
+            function(first, last);
+        });
+    }
+}
+
+// hash_table::link and hash_table::find, on a slab map keyed by hash (the
+// transaction table) with one bucket per element.
+static bool hash_table_link_find(const settings& settings, reporter& out)
+{
+    const auto directory = settings.directory / "hash_table";
+    const auto file = directory / "hash_table";
+
+    if (!clear_directory(directory) || !create_file(file))
+        return false;
+
+    const auto count = settings.samples;
+    std::mt19937_64 random(settings.chain.seed);
+    const auto keys = make_keys(2 * count, random);
+    const auto order = make_order(count, random);
+
+    file_storage storage(file, 1, 50);
+    slab_map table(storage, static_cast<array_index>(count));
+
+    if (!storage.open() || !table.create())
+        return false;
+
+    const auto write = [](byte_serializer& serial)
+    {
+        serial.write_bytes(data_chunk(value_size, 0x42));
+    };
+
+    recorder linking("hash_table.link", "elements");
+    sample_batches(linking, count, [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+        {
+            auto element = table.allocator();
+            element.create(keys[index], write, value_size);
+            table.link(element);
+        }
+    });
+
+    table.commit();
+    out.report(linking.summarize());
+
+    size_t found = 0;
+    recorder hits("hash_table.find.hit", "lookups");
+    sample_batches(hits, count, [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+            if (table.find(keys[order[index]]))
+                ++found;
+    });
+
+    out.report(hits.summarize());
+
+    size_t missed = 0;
+    recorder misses("hash_table.find.miss", "lookups");
+    sample_batches(misses, count, [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+            if (!table.find(keys[count + index]))
+                ++missed;
+    });
+
+    out.report(misses.summarize());
+    return found == count && missed == count && storage.close();
+}
+
+// slab_manager::allocate, of sizes distributed as those of txs.
+static bool slab_manager_allocate(const settings& settings, reporter& out)
+{
+    const auto directory = settings.directory / "slab_manager";
+    const auto file = directory / "slab_manager";
+
+    if (!clear_directory(directory) || !create_file(file))
+        return false;
+
+    const auto count = settings.samples;
+    std::mt19937_64 random(settings.chain.seed);
+    std::vector<size_t> sizes(count);
+
+    for (auto& size: sizes)
+        size = value_size / 2 + random() % (2 * value_size);
+
+    file_storage storage(file, 1, 50);
+    slab_manager<file_offset> manager(storage, 0);
+
+    if (!storage.open() || !manager.create())
+        return false;
+
+    auto allocated = true;
+    recorder allocating("slab_manager.allocate", "slabs");
+    sample_batches(allocating, count, [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+            allocated &= manager.allocate(sizes[index]) !=
+                slab_manager<file_offset>::not_allocated;
+
+        manager.commit();
+    });
+
+    out.report(allocating.summarize());
+    return allocated && storage.close();
+}
+
+void add_primitives(benchmarks& out)
+{
+    out.push_back({ "hash_table", hash_table_link_find });
+    out.push_back({ "slab_manager", slab_manager_allocate });
+}
+
+} // namespace benchmark
@@ -16,20 +16,26 @@
 
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
+#include <bitcoin/database/compression.hpp>
 #include <bitcoin/database/data_base.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/metrics.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
+#include <bitcoin/database/transaction_cache.hpp>
 #include <bitcoin/database/unspent_outputs.hpp>
 #include <bitcoin/database/unspent_transaction.hpp>
+#include <bitcoin/database/update_pipeline.hpp>
 #include <bitcoin/database/verify.hpp>
 #include <bitcoin/database/version.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
 #include <bitcoin/database/databases/filter_database.hpp>
 #include <bitcoin/database/databases/payment_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/databases/utxo_database.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/journal.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
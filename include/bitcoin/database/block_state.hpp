@@ -38,6 +38,9 @@ enum block_state : uint8_t
     candidate = 1 << 2,
     confirmed = 1 << 3,
 
+    /// Txs of a confirmed block below the prune depth may be pruned.
+    pruned = 1 << 4,
+
     validations = failed | valid,
     confirmations = candidate | confirmed
 };
@@ -67,6 +70,13 @@ inline bool is_confirmed(uint8_t state)
     return (state & block_state::confirmed) != 0;
 }
 
+// pruning states
+
+inline bool is_pruned(uint8_t state)
+{
+    return (state & block_state::pruned) != 0;
+}
+
 } // namespace database
 } // namespace libbitcoin
 
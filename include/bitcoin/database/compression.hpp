@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_COMPRESSION_HPP
+#define LIBBITCOIN_DATABASE_COMPRESSION_HPP
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+// Output scripts are stored as a varint tag followed by a payload.
+// Tags below script_templates identify a standard template and are followed
+// by its fixed-size hash or key. Any other script is stored as a tag of
+// (script_templates + size) followed by the full (unprefixed) script.
+
+/// The number of reserved standard script template tags.
+BCD_API extern const size_t script_templates;
+
+/// The size of the script in compressed (stored) form.
+BCD_API size_t compressed_size(const system::chain::script& script);
+
+/// Write the script in compressed (stored) form.
+BCD_API void compress(byte_serializer& serial,
+    const system::chain::script& script);
+
+/// Read a script from compressed (stored) form.
+BCD_API system::chain::script decompress(byte_deserializer& deserial);
+
+/// Write a script in wire form from compressed (stored) form at the address,
+/// without constructing the script, returning its stored size.
+BCD_API size_t decompress(system::writer& sink, uint8_t* data);
+
+/// Skip a script in compressed (stored) form, returning its stored size.
+BCD_API size_t skip_compressed(byte_deserializer& deserial);
+
+/// Skip a script in compressed (stored) form, returning its stored size.
+BCD_API size_t skip_compressed(byte_serializer& serial);
+
+/// Skip a script in compressed (stored) form, returning its stored size and
+/// setting whether the script is unspendable, without constructing it.
+BCD_API size_t skip_compressed(byte_deserializer& deserial,
+    bool& unspendable);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
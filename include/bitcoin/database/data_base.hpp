@@ -20,9 +20,15 @@
 #define LIBBITCOIN_DATABASE_DATA_BASE_HPP
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
@@ -30,6 +36,7 @@
 #include <bitcoin/database/databases/payment_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/metrics.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
 
@@ -43,6 +50,25 @@ class BCD_API data_base
 public:
     typedef std::function<void(const system::code&)> result_handler;
 
+    /// The chain write sequence and the chain tops at the start of a read.
+    struct read_snapshot
+    {
+        size_t sequence;
+        size_t candidate_height;
+        size_t confirmed_height;
+    };
+
+    typedef std::function<void(const read_snapshot&)> read_handler;
+
+    /// The elapsed time of each phase of open.
+    struct open_timing
+    {
+        std::chrono::microseconds lock;
+        std::chrono::microseconds tables;
+        std::chrono::microseconds output_cache;
+        std::chrono::microseconds filter_checkpoints;
+    };
+
     data_base(const settings& settings, bool catalog, bool filter);
 
     // Open and close.
@@ -63,6 +89,15 @@ public:
     /// Call close on destruct.
     ~data_base();
 
+    /// The phase timings of the last open (checkpoints zero until ready).
+    open_timing startup_timing() const;
+
+    /// True once neutrino filter checkpoints are populated after open.
+    bool filter_checkpoints_ready() const;
+
+    /// The latency, lock wait and throughput of each operation since start.
+    metrics::report metrics_report() const;
+
     /// Reader interfaces.
     // ------------------------------------------------------------------------
     // These are const to preclude write operations by public callers.
@@ -77,6 +112,32 @@ public:
     /// Invalid if indexes not initialized.
     const payment_database& payments() const;
 
+    /// Capture the chain write sequence and chain tops to begin a read.
+    read_snapshot begin_read() const;
+
+    /// True if no chain write has overlapped the read since the snapshot.
+    bool is_current(const read_snapshot& snapshot) const;
+
+    /// Invoke the query until it completes with no overlapping chain write.
+    /// Multi-step queries should read at or below the snapshot heights.
+    /// Must not be called from within a chain write, which it would await.
+    void read(const read_handler& query) const;
+
+    /// Write the wire encoding of the block, with txs read from the store.
+    bool block_data(system::writer& sink, const block_result& result,
+        bool witness=true) const;
+
+    /// The wire encoding of the block, with txs read from the store.
+    system::data_chunk block_data(const block_result& result,
+        bool witness=true) const;
+
+    // BLOCK CHAIN (prevout prefetch)
+    /// Populate the prevout metadata of all block inputs, relative to the fork
+    /// point, in parallel with each prevout tx found once. Returns the elapsed
+    /// time, so that the caller may overlap this with validation of another.
+    std::chrono::microseconds populate_prevouts(
+        const system::chain::block& block, size_t fork_height) const;
+
     // Node writers.
     // ------------------------------------------------------------------------
 
@@ -106,6 +167,7 @@ public:
 
     // BLOCK ORGANIZER (reorganize)
     /// Reorganize the block index to the specified fork point.
+    /// Outgoing may be null, in which case outgoing txs are not read.
     system::code reorganize(const system::config::checkpoint& fork_point,
         system::block_const_ptr_list_const_ptr incoming,
         system::block_const_ptr_list_ptr outgoing);
@@ -115,6 +177,11 @@ public:
     system::code confirm(const system::hash_digest& block_hash,
         size_t height);
 
+    // BLOCK ORGANIZER (confirm)
+    /// Confirm contiguous candidate blocks in one write, from first height.
+    system::code confirm(const system::hash_list& block_hashes,
+        size_t first_height);
+
     // TRANSACTION ORGANIZER (store)
     /// Store unconfirmed tx/payments that were verified with the given forks.
     system::code store(const system::chain::transaction& tx, uint32_t forks);
@@ -123,6 +190,25 @@ public:
     /// Add transaction payment to the payment index.
     system::code catalog(const system::chain::transaction& tx);
 
+    // Asynchronous writers.
+    // ------------------------------------------------------------------------
+    // Writes are queued in order to the writer thread, which invokes each
+    // handler on completion. Handlers must not block on other queued writes.
+
+    void push(system::block_const_ptr block, size_t height,
+        uint32_t median_time_past, result_handler handler);
+    void update(system::block_const_ptr block, size_t height,
+        result_handler handler);
+    void candidate(system::block_const_ptr block, result_handler handler);
+    void confirm(const system::hash_digest& block_hash, size_t height,
+        result_handler handler);
+    void store(system::transaction_const_ptr tx, uint32_t forks,
+        result_handler handler);
+    void catalog(system::transaction_const_ptr tx, result_handler handler);
+
+    /// The number of queued asynchronous writes (backpressure).
+    size_t write_queue_depth() const;
+
 protected:
     typedef std::function<system::code(const block_result&, file_offset&)>
         filter_key_extractor;
@@ -140,6 +226,8 @@ protected:
         const system::config::checkpoint& fork_point);
     system::code push_header(const system::chain::header& header, size_t height,
         uint32_t median_time_past);
+    system::code push_headers(const system::header_const_ptr_list& headers,
+        size_t first_height);
     system::code pop_header(system::chain::header& out_header, size_t height);
 
     // Block reorganization.
@@ -151,6 +239,7 @@ protected:
         const system::config::checkpoint& fork_point);
     system::code push_block(const system::chain::block& block, size_t height);
     system::code pop_block(system::chain::block& out_block, size_t height);
+    system::code pop_block(system::hash_digest& out_hash, size_t height);
 
     /// Add transaction payments of the block to the payment index.
     system::code catalog(const system::chain::block& block);
@@ -159,13 +248,16 @@ protected:
     // ------------------------------------------------------------------------
 
     system::code populate_filter_cache(filter_database& database);
+    void stop_filter_loader();
+    void populate_output_cache();
+    void save_output_cache() const;
     system::code update_filter_cache(filter_database& database,
         const system::config::checkpoint& fork_point,
         system::block_const_ptr_list_const_ptr incoming,
-        system::block_const_ptr_list_ptr outgoing);
+        size_t outgoing_count);
 
-    // Add neutrino filter to the filters index.
-    system::code filter(const system::chain::block& block);
+    // Add neutrino filter to the filters index, for the block at link.
+    system::code filter(const system::chain::block& block, array_index link);
 
     // Databases.
     // ------------------------------------------------------------------------
@@ -176,6 +268,41 @@ protected:
     std::shared_ptr<payment_database> payments_;
 
 private:
+    typedef std::function<system::code()> write_function;
+
+    struct write_request
+    {
+        write_function write;
+        result_handler handler;
+
+        // Adjacent confirmations are coalesced into one write.
+        system::hash_digest hash;
+        size_t height;
+        bool confirm;
+    };
+
+    typedef std::deque<write_request> write_queue;
+    typedef std::function<void(size_t)> work_handler;
+
+    system::code confirm(const system::hash_list& block_hashes,
+        size_t first_height, bool partial, size_t& confirmed);
+    system::code verify_confirms(std::vector<block_result>& out_blocks,
+        const system::hash_list& block_hashes, size_t first_height) const;
+    bool confirm(const block_result& block, size_t height);
+    bool prune(size_t height);
+    void reclaim();
+    bool is_pruned_fork(size_t fork_height, size_t top) const;
+    bool open_tables();
+    void start_filter_loader();
+    void enqueue(write_request&& request);
+    void start_writer();
+    void stop_writer();
+    void write_all(write_queue& requests);
+    void writer();
+    void start_workers();
+    void stop_workers();
+    void worker() const;
+    void parallel(size_t count, const work_handler& work) const;
     system::chain::transaction::list to_transactions(
         const block_result& result) const;
 
@@ -186,6 +313,35 @@ private:
 
     // Used to prevent unsafe concurrent writes.
     mutable system::shared_mutex write_mutex_;
+
+    // Chain writes begun and ended, and in progress (for read snapshots).
+    std::atomic<size_t> write_sequence_;
+    std::atomic<size_t> active_writers_;
+
+    // Background population of filter checkpoints on open.
+    std::thread filter_loader_;
+    std::atomic<bool> filter_ready_;
+
+    // Operation metrics, recorded by readers and writers without locking.
+    mutable metrics metrics_;
+
+    // Open phase timings, protected by timing_mutex_.
+    open_timing timing_;
+    mutable std::mutex timing_mutex_;
+
+    // Asynchronous write queue, protected by write_queue_mutex_.
+    bool writer_stopped_;
+    write_queue write_queue_;
+    std::thread writer_;
+    mutable std::mutex write_queue_mutex_;
+    std::condition_variable write_queue_condition_;
+
+    // Persistent worker pool for parallel reads, protected by work_mutex_.
+    bool workers_stopped_;
+    std::vector<std::thread> workers_;
+    mutable std::deque<std::function<void()>> work_queue_;
+    mutable std::mutex work_mutex_;
+    mutable std::condition_variable work_condition_;
 };
 
 } // namespace database
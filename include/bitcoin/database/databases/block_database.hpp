@@ -21,6 +21,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
@@ -40,6 +41,18 @@ class BCD_API block_database
 public:
     typedef boost::filesystem::path path;
 
+    /// Header fields of a candidate|confirmed index entry, held in memory.
+    struct index_entry
+    {
+        system::hash_digest hash;
+        array_index link;
+        uint8_t state;
+        uint32_t bits;
+        uint32_t timestamp;
+        uint32_t median_time_past;
+        file_offset neutrino_filter;
+    };
+
     /// Construct the database.
     block_database(const path& map_filename,
         const path& candidate_index_filename,
@@ -69,6 +82,9 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Journal in-place writes to the memory maps.
+    void set_journal(journal& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -81,6 +97,12 @@ public:
     /// Fetch block by hash.
     block_result get(const system::hash_digest& hash) const;
 
+    /// Fetch indexed header fields by height from memory (no store access).
+    bool get(index_entry& out_entry, size_t height, bool candidate) const;
+
+    /// Determine the presence of each block by hash (without fetching).
+    std::vector<bool> contains(const system::hash_list& hashes) const;
+
     /// Populate header metadata for the given header.
     void get_header_metadata(const system::chain::header& header) const;
 
@@ -88,25 +110,49 @@ public:
     // ------------------------------------------------------------------------
 
     /// Store header, validated at height, candidate, pending (but unindexed).
-    void store(const system::chain::header& header, size_t height,
+    /// Returns the link of the stored header, for use with link overloads.
+    array_index store(const system::chain::header& header, size_t height,
         uint32_t median_time_past);
 
+    /// Store missing headers and promote all to candidate from first height.
+    /// Table and index storage is expanded once for the batch.
+    bool store(const system::header_const_ptr_list& headers,
+        size_t first_height);
+
     /// Populate pooled block transaction references, state is unchanged.
     bool update_transactions(const system::chain::block& block);
+    bool update_transactions(array_index link,
+        const system::chain::block& block);
 
     /// Populate filter reference, state is unchanged.
     bool update_neutrino_filter(const system::hash_digest& hash,
         file_offset link);
+    bool update_neutrino_filter(array_index block, file_offset link);
 
     /// Promote pooled block to valid|invalid and set code.
     bool validate(const system::hash_digest& hash, const system::code& error);
+    bool validate(array_index link, const system::code& error);
 
     /// Promote pooled|candidate block to candidate|confirmed respectively.
     bool promote(const system::hash_digest& hash, size_t height, bool candidate);
+    bool promote(array_index link, size_t height, bool candidate);
 
     /// Demote candidate|confirmed header to pooled|pooled (not candidate).
     bool demote(const system::hash_digest& hash, size_t height,
         bool candidate);
+    bool demote(array_index link, size_t height, bool candidate);
+
+    /// Mark confirmed block as pruned, its txs may no longer be complete.
+    bool prune(array_index link);
+
+    // Relocation.
+    // ------------------------------------------------------------------------
+
+    /// The number of tx links in the tx index, across all blocks.
+    size_t transaction_links() const;
+
+    /// Replace the tx links in [first, last) of the tx index (not journaled).
+    void relocate(const relocator& relocate, size_t first, size_t last);
 
 private:
     typedef system::hash_digest key_type;
@@ -119,11 +165,19 @@ private:
 
     link_type associate(const system::chain::transaction::list& transactions);
     void promote(const_element& element, bool positive, bool candidate);
-    void store(const system::chain::header& header, size_t height,
+    link_type store(const system::chain::header& header, size_t height,
         uint32_t median_time_past, uint32_t checksum, link_type tx_start,
         size_t tx_count, uint8_t status);
 
     // Index Utilities.
+    typedef std::vector<index_entry> index_mirror;
+    bool load_mirror(index_mirror& mirror, const manager_type& manager);
+    index_entry read_entry(link_type link) const;
+    void update_mirror(link_type link, size_t height, uint8_t state);
+    void update_mirror_filter(link_type link, size_t height,
+        file_offset filter);
+    index_mirror& mirror(const manager_type& manager);
+    const index_mirror& mirror(const manager_type& manager) const;
     bool read_top(size_t& out_height, const manager_type& manager) const;
     link_type read_link(size_t height, const manager_type& manager) const;
     void pop_link(link_type link, size_t height, manager_type& manager);
@@ -152,6 +206,11 @@ private:
 
     // This provides atomicity for checksum, tx_start, tx_count, state.
     mutable system::shared_mutex metadata_mutex_;
+
+    // In-memory copies of the candidate and confirmed indexes, by height.
+    index_mirror candidate_mirror_;
+    index_mirror confirmed_mirror_;
+    mutable system::shared_mutex mirror_mutex_;
 };
 
 } // namespace database
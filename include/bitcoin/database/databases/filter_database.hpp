@@ -69,6 +69,9 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Journal in-place writes to the memory maps.
+    void set_journal(journal& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
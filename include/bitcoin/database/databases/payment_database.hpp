@@ -64,6 +64,9 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Journal in-place writes to the memory maps.
+    void set_journal(journal& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -76,6 +79,15 @@ public:
     /// Add a row for each payment recorded in the transaction.
     void catalog(const system::chain::transaction& tx);
 
+    // Relocation.
+    //-------------------------------------------------------------------------
+
+    /// The number of payment rows, across all payment hashes.
+    size_t payment_rows() const;
+
+    /// Replace the tx links of rows in [first, last) (not journaled).
+    void relocate(const relocator& relocate, size_t first, size_t last);
+
 protected:
     /// Store the input|output point as a value for the hash of output
     /// script as the key
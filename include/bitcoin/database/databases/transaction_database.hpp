@@ -20,13 +20,16 @@
 #define LIBBITCOIN_DATABASE_TRANSACTION_DATABASE_HPP
 
 #include <cstddef>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/databases/utxo_database.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
+#include <bitcoin/database/transaction_cache.hpp>
 #include <bitcoin/database/unspent_outputs.hpp>
 
 namespace libbitcoin {
@@ -41,10 +44,14 @@ class BCD_API transaction_database
 {
 public:
     typedef boost::filesystem::path path;
+    typedef std::vector<const system::chain::output_point*> point_group;
 
     /// Construct the database.
-    transaction_database(const path& map_filename, size_t table_minimum,
-        uint32_t buckets, size_t expansion, size_t cache_capacity);
+    transaction_database(const path& map_filename,
+        const path& witness_filename, const path& utxo_filename,
+        size_t table_minimum, size_t witness_minimum, size_t utxo_minimum,
+        uint32_t buckets, uint32_t utxo_buckets, size_t expansion,
+        size_t cache_capacity, size_t transaction_cache_capacity);
 
     /// Close the database (all threads must first be stopped).
     ~transaction_database();
@@ -67,6 +74,22 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Journal in-place writes to the memory maps.
+    void set_journal(journal& log);
+
+    // Output cache warm start.
+    // ------------------------------------------------------------------------
+
+    /// Load the output cache from a snapshot taken at the top hash.
+    bool load_cache(const path& filename, const system::hash_digest& top);
+
+    /// Save a snapshot of the output cache taken at the top hash.
+    bool save_cache(const path& filename,
+        const system::hash_digest& top) const;
+
+    /// Cache the unspent outputs of a confirmed transaction.
+    bool cache(file_offset link);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -76,6 +99,16 @@ public:
     /// Fetch transaction by its hash.
     transaction_result get(const system::hash_digest& hash) const;
 
+    /// Determine the presence of each transaction by hash (without fetching).
+    std::vector<bool> contains(const system::hash_list& hashes) const;
+
+    /// Fetch decoded transaction by its link (cached).
+    system::chain::transaction get_transaction(file_offset link,
+        bool witness=true) const;
+
+    /// The decoded transaction cache performance (hits to accesses).
+    float transaction_cache_hit_rate() const;
+
     /// Populate tx metadata for the given block context.
     void get_block_metadata(const system::chain::transaction& tx,
         uint32_t forks, size_t fork_height) const;
@@ -88,6 +121,9 @@ public:
     bool get_output(const system::chain::output_point& point,
         size_t fork_height) const;
 
+    /// Populate output metadata for points of one tx, finding the tx once.
+    void get_outputs(const point_group& points, size_t fork_height) const;
+
     // Writers.
     // ------------------------------------------------------------------------
 
@@ -111,9 +147,28 @@ public:
     bool confirm(const system::chain::block& block, size_t height,
         uint32_t median_time_past);
 
+    /// Demote the transaction to pooled, without reading the transaction.
+    bool unconfirm(file_offset link);
+
     /// Demote the set of transactions associated with a block to pooled.
     bool unconfirm(const system::chain::block& block);
 
+    /// Prune the tx body if confirmed and fully spent at or below height.
+    bool prune(file_offset link, size_t height);
+
+    /// Reclaim the storage of txs pruned since the last reclaim.
+    /// This must not be called until the pruning has been committed and the
+    /// journal cleared. Prune and reclaim must not be called concurrently.
+    bool reclaim();
+
+    // Relocation.
+    // ------------------------------------------------------------------------
+
+    /// Copy the stored tx at the source link, unless its hash is stored.
+    /// The copy retains its metadata, and a pruned tx remains pruned.
+    bool relocate(file_offset& out_link, const transaction_database& source,
+        file_offset link);
+
 private:
     typedef system::hash_digest key_type;
     typedef array_index index_type;
@@ -121,11 +176,30 @@ private:
     typedef slab_manager<link_type> manager_type;
     typedef hash_table<manager_type, index_type, link_type, key_type> slab_map;
 
+    // The stored extents of a pruned tx body.
+    struct pruned_extent
+    {
+        link_type link;
+        size_t size;
+        link_type witness;
+        size_t witness_size;
+    };
+
     // Store a transaction.
     //-------------------------------------------------------------------------
     bool storize(const system::chain::transaction& tx, size_t height,
         uint32_t median_time_past, size_t position);
 
+    // Populate output metadata for the point from its tx result.
+    static bool populate_output(const transaction_result& result,
+        const system::chain::output_point& point, size_t fork_height);
+
+    // Store the witnesses of a segregated tx, returns the witness link.
+    file_offset store_witness(const system::chain::transaction& tx);
+
+    // The stored size of the witnesses of a tx with the given input count.
+    size_t stored_witness_size(file_offset witness, size_t inputs) const;
+
     // Update the candidate state of the tx.
     //-------------------------------------------------------------------------
     bool candidate(file_offset link, bool positive);
@@ -146,15 +220,30 @@ private:
     bool confirmize(link_type link, size_t height, uint32_t median_time_past,
         size_t position);
 
+    // Add or remove the outputs of a (de)confirmed tx in the utxo table.
+    void confirm_outputs(link_type link, size_t height,
+        uint32_t median_time_past, size_t position);
+
     // Hash table used for looking up txs by hash.
     file_storage hash_table_file_;
     slab_map hash_table_;
 
-    // This is thread safe.
+    // Slab storage of witnesses, linked from segregated txs.
+    file_storage witness_file_;
+    manager_type witness_manager_;
+
+    // Hash table of confirmed unspent outputs.
+    utxo_database utxo_;
+
+    // These are thread safe.
     unspent_outputs cache_;
+    mutable transaction_cache transaction_cache_;
 
     // This provides atomicity for height and position.
     mutable system::shared_mutex metadata_mutex_;
+
+    // Pruned extents pending reclamation, protected by the writer.
+    std::vector<pruned_extent> pruned_;
 };
 
 } // namespace database
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_UTXO_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_UTXO_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This enables lookups of confirmed unspent outputs by output point.
+/// Outputs are added upon confirmation of their tx and removed upon confirmed
+/// spend or deconfirmation, so that the table is the confirmed utxo set.
+class BCD_API utxo_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Construct the database.
+    utxo_database(const path& map_filename, size_t table_minimum,
+        uint32_t buckets, size_t expansion);
+
+    /// Close the database (all threads must first be stopped).
+    ~utxo_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new utxo database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory map to disk.
+    bool flush() const;
+
+    /// Call to unload the memory map.
+    bool close();
+
+    /// Journal in-place writes to the memory maps.
+    void set_journal(journal& log);
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Populate output metadata if confirmed unspent, relative to fork point.
+    bool populate(const system::chain::output_point& point,
+        size_t fork_height) const;
+
+    // Writers.
+    // ------------------------------------------------------------------------
+
+    /// Store a confirmed unspent output (replaces a duplicate point).
+    bool store(const system::chain::output_point& point,
+        const system::chain::output& output, size_t height,
+        uint32_t median_time_past, bool coinbase);
+
+    /// Remove an output that has been confirmed spent or deconfirmed.
+    bool remove(const system::chain::output_point& point);
+
+    /// Update the candidate spent state of the output, if present.
+    bool candidate(const system::chain::output_point& point, bool positive);
+
+private:
+    typedef system::byte_array<system::hash_size + sizeof(uint32_t)>
+        key_type;
+    typedef array_index index_type;
+    typedef file_offset link_type;
+    typedef slab_manager<link_type> manager_type;
+    typedef hash_table<manager_type, index_type, link_type, key_type> slab_map;
+
+    static key_type to_key(const system::chain::output_point& point);
+
+    // Hash table used for looking up outputs by point.
+    file_storage hash_table_file_;
+    slab_map hash_table_;
+
+    // This provides atomicity for candidate spent.
+    mutable system::shared_mutex metadata_mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
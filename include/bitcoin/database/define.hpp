@@ -21,6 +21,7 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <tuple>
 #include <vector>
 #include <bitcoin/system.hpp>
@@ -51,6 +52,7 @@ namespace database {
 typedef uint32_t array_index;
 typedef uint64_t file_offset;
 typedef std::vector<file_offset> link_list;
+typedef std::function<file_offset(file_offset)> relocator;
 typedef bc::system::serializer<uint8_t*> byte_serializer;
 typedef bc::system::deserializer<uint8_t*, false> byte_deserializer;
 typedef std::array<uint8_t, 0> empty_key;
@@ -19,7 +19,10 @@
 #ifndef LIBBITCOIN_DATABASE_HASH_TABLE_IPP
 #define LIBBITCOIN_DATABASE_HASH_TABLE_IPP
 
+#include <algorithm>
 #include <cstddef>
+#include <utility>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/hash_table_header.hpp>
@@ -75,6 +78,12 @@ hash_table<Manager, Index, Link, Key>::allocator()
     return { manager_, list_mutex_ };
 }
 
+template <typename Manager, typename Index, typename Link, typename Key>
+bool hash_table<Manager, Index, Link, Key>::reserve(size_t count)
+{
+    return manager_.reserve(count);
+}
+
 template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::const_value_type
 hash_table<Manager, Index, Link, Key>::find(const Key& key) const
@@ -89,6 +98,44 @@ hash_table<Manager, Index, Link, Key>::find(const Key& key) const
     return *list.end();
 }
 
+// Sorting by bucket makes header reads monotonic, so that the memory map
+// pages of a large batch are faulted in order, and empty buckets end early.
+template <typename Manager, typename Index, typename Link, typename Key>
+std::vector<bool> hash_table<Manager, Index, Link, Key>::contains(
+    const std::vector<Key>& keys) const
+{
+    std::vector<std::pair<Index, size_t>> order;
+    order.reserve(keys.size());
+
+    for (size_t position = 0; position < keys.size(); ++position)
+        order.emplace_back(bucket_index(keys[position]), position);
+
+    std::sort(order.begin(), order.end());
+    std::vector<bool> result(keys.size(), false);
+
+    for (const auto& bucket: order)
+    {
+        const auto start = bucket_value(bucket.first);
+
+        if (start == not_found)
+            continue;
+
+        const auto& key = keys[bucket.second];
+        list<const Manager, Link, Key> list(manager_, start, list_mutex_);
+
+        for (const auto item: list)
+        {
+            if (item.match(key))
+            {
+                result[bucket.second] = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
 template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::const_value_type
 hash_table<Manager, Index, Link, Key>::get(Link link) const
@@ -113,7 +113,9 @@ void hash_table_header<Index, Link>::write(Index index, Link value)
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
-    serial.template write_little_endian<Link>(value);
+
+    if (file_.preserve(memory->buffer(), sizeof(Link)))
+        serial.template write_little_endian<Link>(value);
     ///////////////////////////////////////////////////////////////////////////
 }
 
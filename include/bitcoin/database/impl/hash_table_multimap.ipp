@@ -142,7 +142,7 @@ void hash_table_multimap<Index, Link, Key>::link(const Key& key,
         element.set_next(first);
 
         // "link" existing root to the new first element.
-        root.write(writer);
+        root.write(writer, 0, sizeof(Link));
     }
 
     root_mutex_.unlock();
@@ -198,7 +198,7 @@ bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
 
     root_mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    root.write(writer);
+    root.write(writer, 0, sizeof(Link));
 
     root_mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
@@ -106,13 +106,27 @@ Link list_element<Manager, Link, Key>::create(const Key& key,
 }
 
 template <typename Manager, typename Link, typename Key>
-void list_element<Manager, Link, Key>::write(write_function writer) const
+void list_element<Manager, Link, Key>::write(write_function writer,
+    size_t offset, size_t size) const
 {
     const auto memory = data(std::tuple_size<Key>::value + sizeof(Link));
+
+    if (!manager_.preserve(memory->buffer() + offset, size))
+        return;
+
     auto serial = system::make_unsafe_serializer(memory->buffer());
     writer(serial);
 }
 
+// This call assumes the manager is a slab_manager.
+template <typename Manager, typename Link, typename Key>
+bool list_element<Manager, Link, Key>::reclaim(size_t offset,
+    size_t size) const
+{
+    const auto memory = data(std::tuple_size<Key>::value + sizeof(Link));
+    return manager_.reclaim(memory->buffer() + offset, size);
+}
+
 // Jump to the next element in the list.
 template <typename Manager, typename Link, typename Key>
 bool list_element<Manager, Link, Key>::jump_next()
@@ -141,7 +155,9 @@ void list_element<Manager, Link, Key>::set_next(Link next) const
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
-    serial.template write_little_endian<Link>(next);
+
+    if (manager_.preserve(memory->buffer(), sizeof(Link)))
+        serial.template write_little_endian<Link>(next);
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -153,6 +169,12 @@ void list_element<Manager, Link, Key>::read(read_function reader) const
     reader(deserial);
 }
 
+template <typename Manager, typename Link, typename Key>
+memory_ptr list_element<Manager, Link, Key>::value() const
+{
+    return data(std::tuple_size<Key>::value + sizeof(Link));
+}
+
 template <typename Manager, typename Link, typename Key>
 bool list_element<Manager, Link, Key>::match(const Key& key) const
 {
@@ -136,6 +136,30 @@ Link record_manager<Link>::allocate(size_t count)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// This allows a batch of allocations to incur at most one file expansion.
+template <typename Link>
+bool record_manager<Link>::reserve(size_t count)
+{
+    BITCOIN_ASSERT(count < not_allocated);
+    const auto records = static_cast<Link>(count);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    system::unique_lock lock(mutex_);
+
+    const auto current_size = header_size_ + link_to_position(record_count_);
+    const auto required_size = header_size_ +
+        link_to_position(record_count_ + records);
+
+    // Currently throws runtime_error if insufficient space.
+    if (!file_.reserve(required_size))
+        return false;
+
+    // Restore the logical size, retaining the expanded capacity.
+    return !!file_.reserve(current_size);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 template <typename Link>
 memory_ptr record_manager<Link>::get(Link link) const
 {
@@ -148,6 +172,12 @@ memory_ptr record_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+bool record_manager<Link>::preserve(const uint8_t* address, size_t size) const
+{
+    return file_.preserve(address, size);
+}
+
 template <typename Link>
 bool record_manager<Link>::past_eof(Link link) const
 {
@@ -178,6 +208,10 @@ void record_manager<Link>::write_count()
     // The accessor must remain in scope until the end of the block.
     const auto memory = file_.access();
     memory->increment(header_size_);
+
+    if (!file_.preserve(memory->buffer(), sizeof(Link)))
+        return;
+
     auto serial = system::make_unsafe_serializer(memory->buffer());
     serial.template write_little_endian<Link>(record_count_);
 }
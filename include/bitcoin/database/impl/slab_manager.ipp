@@ -135,6 +135,18 @@ memory_ptr slab_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+bool slab_manager<Link>::preserve(const uint8_t* address, size_t size) const
+{
+    return file_.preserve(address, size);
+}
+
+template <typename Link>
+bool slab_manager<Link>::reclaim(const uint8_t* address, size_t size) const
+{
+    return file_.reclaim(address, size);
+}
+
 template <typename Link>
 bool slab_manager<Link>::past_eof(Link link) const
 {
@@ -165,6 +177,10 @@ void slab_manager<Link>::write_size() const
     // The accessor must remain in scope until the end of the block.
     const auto memory = file_.access();
     memory->increment(header_size_);
+
+    if (!file_.preserve(memory->buffer(), sizeof(Link)))
+        return;
+
     auto serial = system::make_unsafe_serializer(memory->buffer());
 
     // TODO: C4267: 'argument': conversion from 'size_t' to 'Integer', possible loss of data.
@@ -30,6 +30,7 @@
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/journal.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
 
@@ -84,6 +85,15 @@ public:
     /// Increase the physical size to at least the logical size.
     memory_ptr reserve(size_t required);
 
+    /// Journal the current value of mapped data before it is overwritten.
+    bool preserve(const uint8_t* address, size_t size);
+
+    /// Reclaim the physical storage of whole pages within the range.
+    bool reclaim(const uint8_t* address, size_t size);
+
+    /// Set the journal of in-place writes, no journaling if not set.
+    void set_journal(journal& log);
+
 private:
     static size_t file_size(int file_handle);
     static int close_file(int file_handle);
@@ -111,6 +121,7 @@ private:
     const size_t minimum_;
     const size_t expansion_;
     const boost::filesystem::path filename_;
+    std::atomic<journal*> journal_;
 
     // Protected by mutex.
     bool closed_;
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_JOURNAL_HPP
+#define LIBBITCOIN_DATABASE_JOURNAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// An undo log of in-place writes to memory mapped files. The prior value of
+/// each file range is logged before it is overwritten, and the log is cleared
+/// once no write is in progress. Following a crash the log contains only the
+/// ranges changed by interrupted writes, which rollback restores.
+/// Each entry reaches the file system as it is recorded, so entries survive
+/// termination of the process, as do unflushed pages of the mapped files. A
+/// synchronized log is also forced to disk by flush, once per write before
+/// the mapped files are flushed, so that its entries survive termination of
+/// the system. An unsynchronized log is restored only within the system boot
+/// in which it was written, as otherwise mapped pages and entries may be lost.
+/// A mapped page written back by the system before the log is forced is not
+/// covered on termination of the system.
+/// A range that cannot be recorded must not be overwritten, and the write
+/// then fails to end, so that it is rolled back on restart.
+class BCD_API journal
+  : system::noncopyable
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Construct a journal of the given file (files must share directory).
+    journal(const path& filename, bool synchronize);
+
+    /// Close the journal.
+    ~journal();
+
+    /// Create or truncate the log file, restore any entries before opening.
+    bool open();
+
+    /// Close the log file, retaining any entries.
+    bool close();
+
+    /// Begin a write, writes may overlap.
+    void begin();
+
+    /// End a write, clearing the log if no write remains in progress.
+    /// False if an entry has failed to record since open (log retained).
+    bool end();
+
+    /// Force recorded entries to disk if synchronizing (otherwise true).
+    bool flush();
+
+    /// True if no write is in progress and the log holds no entries.
+    bool is_clear() const;
+
+    /// Log the current value of a file range before it is overwritten.
+    /// False if not logged, in which case the range must not be overwritten.
+    bool record(const path& file, file_offset position, const uint8_t* data,
+        size_t size);
+
+    /// Restore logged ranges in reverse order and clear the log.
+    /// A partially-logged final entry is ignored, as its range is unchanged.
+    /// False if the log was not synchronized and the system has restarted
+    /// since it was written, as entries and mapped pages may have been lost.
+    static bool rollback(const path& filename);
+
+    /// An identifier of the current system boot, empty if not available.
+    static std::string boot_identity();
+
+private:
+    // Log: [synchronized:1][boot identity:string][entry]...
+    // Entry: [file name:string][position:8][size:4][prior value:size].
+    struct entry
+    {
+        std::string name;
+        file_offset position;
+        system::data_chunk data;
+    };
+
+    typedef std::unique_ptr<system::ofstream> stream_ptr;
+
+    bool reset();
+    bool synchronize() const;
+
+    const path filename_;
+    const bool synchronize_;
+    const std::string boot_;
+
+    // Protected by mutex.
+    size_t writers_;
+    bool dirty_;
+    bool synchronized_;
+    bool failed_;
+    stream_ptr stream_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
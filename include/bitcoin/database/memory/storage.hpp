@@ -59,6 +59,15 @@ public:
     /// Resize the logical map to the specified size, return access.
     /// Increase the physical size to at least the logical size.
     virtual memory_ptr reserve(size_t required) = 0;
+
+    /// Preserve the current value of mapped data before it is overwritten.
+    /// The address must be within memory accessed from this instance.
+    /// False if not preserved, in which case it must not be overwritten.
+    virtual bool preserve(const uint8_t* address, size_t size) = 0;
+
+    /// Reclaim the physical storage of whole pages within the range, which
+    /// subsequently read as zero. The address must be within accessed memory.
+    virtual bool reclaim(const uint8_t* address, size_t size) = 0;
 };
 
 } // namespace database
@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_METRICS_HPP
+#define LIBBITCOIN_DATABASE_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A registry of latency, lock wait and throughput for each store operation.
+/// Latencies are recorded to log-linear (HDR style) histograms of microseconds
+/// with 32 linear buckets per power of two, a relative error under 1/32.
+/// Recording is lock-free and allocation-free, so the registry is always on.
+class BCD_API metrics
+  : system::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::microseconds duration;
+
+    enum operation : uint8_t
+    {
+        push,
+        update,
+        invalidate,
+        candidate,
+        confirm,
+        store,
+        catalog,
+        reorganize_headers,
+        push_headers,
+        pop_header,
+        reorganize_blocks,
+        push_block,
+        pop_block,
+        catalog_block,
+        filter,
+        read,
+        prefetch,
+        flush
+    };
+
+    static const size_t operations = operation::flush + 1;
+
+    /// A latency distribution, percentiles are bucket upper bounds.
+    struct distribution
+    {
+        uint64_t count;
+        duration total;
+        duration maximum;
+        duration p50;
+        duration p90;
+        duration p99;
+        duration p999;
+    };
+
+    /// The metrics of one operation, units are blocks, headers, txs or reads.
+    struct operation_metrics
+    {
+        std::string name;
+        uint64_t units;
+        distribution latency;
+        distribution lock_wait;
+    };
+
+    /// A copy of all operation metrics, with the time since construction.
+    struct report
+    {
+        duration uptime;
+        std::vector<operation_metrics> operations;
+    };
+
+    /// Records the latency of an operation on destruct.
+    class BCD_API timer
+      : system::noncopyable
+    {
+    public:
+        timer(metrics& registry, operation operation, size_t units=1);
+        ~timer();
+
+        /// Record the lock wait, subsequent latency excludes the wait.
+        void locked();
+
+        /// Set the units of work (when not known at construct).
+        void set_units(size_t units);
+
+    private:
+        metrics& registry_;
+        const metrics::operation operation_;
+        size_t units_;
+        clock::time_point start_;
+    };
+
+    metrics();
+
+    /// The name of the operation.
+    static std::string to_string(operation operation);
+
+    /// Record the latency and units of work of an operation.
+    void record(operation operation, const duration& latency,
+        size_t units=1);
+
+    /// Record the time spent waiting on the lock of an operation.
+    void record_wait(operation operation, const duration& wait);
+
+    /// Copy the current metrics, suitable for export.
+    report snapshot() const;
+
+private:
+    class histogram
+    {
+    public:
+        static const size_t sub_bucket_bits = 5;
+        static const size_t sub_buckets = 1u << sub_bucket_bits;
+        static const size_t max_exponent = 27;
+        static const size_t buckets = (max_exponent + 1) * sub_buckets;
+
+        static size_t to_bucket(uint64_t value);
+        static uint64_t to_upper(size_t bucket);
+
+        histogram();
+
+        void record(uint64_t value);
+        distribution summarize() const;
+
+    private:
+        std::atomic<uint64_t> total_;
+        std::atomic<uint64_t> maximum_;
+        std::array<std::atomic<uint64_t>, buckets> buckets_;
+    };
+
+    struct entry
+    {
+        std::atomic<uint64_t> units;
+        histogram latency;
+        histogram lock_wait;
+    };
+
+    const clock::time_point start_;
+    std::array<entry, operations> entries_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
@@ -82,9 +83,15 @@ public:
     /// Use to allocate an element in the hash table.
     value_type allocator();
 
+    /// Expand capacity for the given number of elements (record tables only).
+    bool reserve(size_t count);
+
     /// Find an element with the given key in the hash table.
     const_value_type find(const Key& key) const;
 
+    /// Determine the presence of each key, visiting buckets in table order.
+    std::vector<bool> contains(const std::vector<Key>& keys) const;
+
     /// Get the element with the given link from the hash table.
     const_value_type get(Link link) const;
 
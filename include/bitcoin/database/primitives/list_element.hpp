@@ -67,11 +67,18 @@ public:
     void set_next(Link next) const;
 
     /// Write to the state of the element (write to file).
-    void write(write_function writer) const;
+    /// The write is confined to size bytes at offset from the value start.
+    void write(write_function writer, size_t offset, size_t size) const;
 
     /// Read from the state of the element.
     void read(read_function reader) const;
 
+    /// The memory of the element value, remap safe while held.
+    memory_ptr value() const;
+
+    /// Reclaim the storage of size bytes at offset from the value start.
+    bool reclaim(size_t offset, size_t size) const;
+
     /// True if the element key (read from file) matches the parameter.
     bool match(const Key& key) const;
 
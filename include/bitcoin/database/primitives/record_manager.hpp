@@ -64,9 +64,16 @@ public:
     /// Allocate records and return first logical index, commit after writing.
     Link allocate(size_t count);
 
+    /// Expand capacity for the given number of records, without allocation.
+    bool reserve(size_t count);
+
     /// Return memory object for the record at the specified index.
     memory_ptr get(Link link) const;
 
+    /// Preserve the current value of accessed memory before overwriting it.
+    /// False if not preserved, in which case it must not be overwritten.
+    bool preserve(const uint8_t* address, size_t size) const;
+
 private:
     // The record index of a disk position.
     Link position_to_link(file_offset position) const;
@@ -63,6 +63,13 @@ public:
     /// Return memory object for the slab at the specified position.
     memory_ptr get(Link position) const;
 
+    /// Preserve the current value of accessed memory before overwriting it.
+    /// False if not preserved, in which case it must not be overwritten.
+    bool preserve(const uint8_t* address, size_t size) const;
+
+    /// Reclaim the physical storage of the slab range (reads as zero).
+    bool reclaim(const uint8_t* address, size_t size) const;
+
 private:
     // Read the size of the data from the file.
     void read_size();
@@ -79,6 +79,9 @@ public:
     /// The state of the block (flags).
     uint8_t state() const;
 
+    /// True if txs of the block may be pruned (body cannot be read).
+    bool pruned() const;
+
     /// The full block p2p message checksum (presumed invalid if zero).
     uint32_t checksum() const;
 
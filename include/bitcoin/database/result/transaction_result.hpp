@@ -55,8 +55,11 @@ public:
     /// This is deconfirmed tx position sentinel.
     static const uint16_t deconfirmed;
 
+    /// This is pruned tx witness link sentinel (body not retained).
+    static const file_offset pruned_body;
+
     transaction_result(const const_element_type& element,
-        system::shared_mutex& metadata_mutex);
+        const manager& witness_manager, system::shared_mutex& metadata_mutex);
 
     /// True if this transaction result is valid (found).
     operator bool() const;
@@ -79,6 +82,9 @@ public:
     /// The median time past of the block which includes the transaction.
     uint32_t median_time_past() const;
 
+    /// The confirmed and fully spent tx body is not retained (metadata only).
+    bool pruned() const;
+
     /// All tx outputs confirmed below fork or as candidates.
     bool is_candidate_spent(size_t fork_height) const;
 
@@ -91,6 +97,13 @@ public:
     /// The transaction, optionally including witness.
     system::chain::transaction transaction(bool witness=true) const;
 
+    /// Write the wire encoding of the transaction directly from the store.
+    /// False if the tx body is pruned (not retained) or the write fails.
+    bool to_data(system::writer& sink, bool witness=true) const;
+
+    /// The wire encoding of the transaction, read directly from the store.
+    system::data_chunk to_data(bool witness=true) const;
+
     /// Iterate over the input set.
     inpoint_iterator begin() const;
     inpoint_iterator end() const;
@@ -100,9 +113,11 @@ private:
     uint32_t height_;
     uint16_t position_;
     uint32_t median_time_past_;
+    file_offset witness_;
 
-    // This class is thread safe.
+    // These classes are thread safe.
     const const_element_type element_;
+    const manager& witness_manager_;
 
     // Metadata values are kept consistent by mutex.
     system::shared_mutex& metadata_mutex_;
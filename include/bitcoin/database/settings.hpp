@@ -36,16 +36,27 @@ public:
     /// Properties.
     boost::filesystem::path directory;
     bool flush_writes;
-    uint32_t cache_capacity;
+
+    /// Unspent output cache size in transactions (converted to bytes).
+    uint64_t cache_capacity;
+    uint32_t cache_warmup_blocks;
+
+    /// Decoded transaction cache size in bytes.
+    uint64_t transaction_cache_capacity;
+
+    uint32_t prune_depth;
     uint16_t file_growth_rate;
     uint32_t block_table_buckets;
     uint32_t transaction_table_buckets;
     uint32_t payment_table_buckets;
+    uint32_t utxo_table_buckets;
     uint64_t block_table_size;
     uint64_t candidate_index_size;
     uint64_t confirmed_index_size;
     uint64_t transaction_index_size;
     uint64_t transaction_table_size;
+    uint64_t witness_table_size;
+    uint64_t utxo_table_size;
     uint64_t payment_index_size;
     uint64_t payment_table_size;
     uint32_t neutrino_filter_table_buckets;
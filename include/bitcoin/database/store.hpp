@@ -24,6 +24,7 @@
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/journal.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -36,12 +37,16 @@ public:
 
     static const std::string FLUSH_LOCK;
     static const std::string EXCLUSIVE_LOCK;
+    static const std::string JOURNAL;
     static const std::string BLOCK_TABLE;
     static const std::string CANDIDATE_INDEX;
     static const std::string CONFIRMED_INDEX;
     static const std::string NEUTRINO_FILTER_TABLE;
     static const std::string TRANSACTION_INDEX;
     static const std::string TRANSACTION_TABLE;
+    static const std::string WITNESS_TABLE;
+    static const std::string UTXO_TABLE;
+    static const std::string OUTPUT_CACHE;
     static const std::string PAYMENT_TABLE;
     static const std::string PAYMENT_ROWS;
 
@@ -57,7 +62,9 @@ public:
     /// Create database files.
     virtual bool create();
 
-    /// Acquire exclusive access.
+    /// Acquire exclusive access, restoring the journal of an interrupted
+    /// write. Without flushing each write, an interrupted session is restored
+    /// only following termination of the process (not of the system).
     virtual bool open();
 
     /// Release exclusive access.
@@ -66,10 +73,10 @@ public:
     // Write with flush detection.
     // ------------------------------------------------------------------------
 
-    /// Start sequence write with optional flush lock.
+    /// Start sequence write with optional flush lock, journal writes.
     virtual bool begin_write() const;
 
-    /// End sequence write with optional flush unlock.
+    /// End sequence write with optional flush unlock, clear the journal.
     virtual bool end_write() const;
 
     /// True if write flushing is enabled.
@@ -84,10 +91,15 @@ public:
     const path confirmed_index;
     const path transaction_index;
     const path transaction_table;
+    const path witness_table;
+    const path utxo_table;
 
     /// Optional store.
     const path neutrino_filter_table;
 
+    /// Output cache snapshot (written on close, consumed on open).
+    const path output_cache;
+
     /// Optional indexes.
     const path payment_table;
     const path payment_rows;
@@ -96,14 +108,19 @@ protected:
     // The implementation must flush all data to disk here.
     virtual bool flush() const = 0;
 
+    // The implementation must journal all in-place writes here.
+    journal& write_journal();
 
 private:
+    bool recover();
+
     const path prefix_;
     const bool with_indexes_;
     const bool with_neutrino_;
     const bool flush_each_write_;
     mutable system::flush_lock flush_lock_;
     mutable system::interprocess_lock exclusive_lock_;
+    mutable journal journal_;
 };
 
 } // namespace database
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_TRANSACTION_CACHE_HPP
+#define LIBBITCOIN_DATABASE_TRANSACTION_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A sharded least-recently-used cache of [link, decoded transaction].
+class BCD_API transaction_cache
+  : system::noncopyable
+{
+public:
+    /// Construct a cache with the specified (approximate) byte limit.
+    transaction_cache(size_t capacity);
+
+    /// The cache capacity is zero.
+    bool disabled() const;
+
+    /// The cache has no elements.
+    bool empty() const;
+
+    /// The number of elements in the cache.
+    size_t size() const;
+
+    /// The cache performance as a ratio of hits to accesses.
+    float hit_rate() const;
+
+    /// Add a tx decoded with witness to the cache (evicts least recent).
+    void add(file_offset link, const system::chain::transaction& tx);
+
+    /// Add as above, unless the link's shard was invalidated since epoch.
+    void add(file_offset link, const system::chain::transaction& tx,
+        size_t epoch);
+
+    /// The invalidation epoch of the link's shard, read before decoding.
+    size_t epoch(file_offset link) const;
+
+    /// Remove a tx from the cache (its stored metadata has changed).
+    void remove(file_offset link);
+
+    /// Remove all txs from the cache.
+    void clear();
+
+    /// Populate tx if cached, a segregated tx only satisfies witness.
+    bool populate(system::chain::transaction& out_tx, file_offset link,
+        bool witness) const;
+
+private:
+    struct entry
+    {
+        file_offset link;
+        size_t bytes;
+        bool segregated;
+        system::chain::transaction tx;
+    };
+
+    // The list is ordered by recency of use, most recent first.
+    typedef std::list<entry> entries;
+    typedef std::unordered_map<file_offset, entries::iterator> index;
+
+    struct shard
+    {
+        size_t bytes = 0;
+        std::atomic<size_t> epoch{ 0 };
+        entries recent;
+        index links;
+        mutable system::upgrade_mutex mutex;
+    };
+
+    static const size_t shards = 16;
+
+    shard& get_shard(file_offset link) const;
+    void add(shard& shard, file_offset link,
+        const system::chain::transaction& tx, const size_t* epoch);
+
+    // These are thread safe.
+    const size_t capacity_;
+    mutable std::atomic<size_t> hits_;
+    mutable std::atomic<size_t> queries_;
+
+    // Each shard is protected by its own mutex.
+    mutable std::array<shard, shards> shards_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -19,12 +19,13 @@
 #ifndef LIBBITCOIN_DATABASE_UNSPENT_OUTPUTS_HPP
 #define LIBBITCOIN_DATABASE_UNSPENT_OUTPUTS_HPP
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <boost/bimap.hpp>
-#include <boost/bimap/set_of.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
+#include <list>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/unspent_transaction.hpp>
@@ -33,12 +34,16 @@ namespace libbitcoin {
 namespace database {
 
 /// This class is thread safe.
-/// A circular-by-age hash table of [point, output].
+/// A sharded hash table of [point, output] with CLOCK (second chance) eviction.
 class BCD_API unspent_outputs
   : system::noncopyable
 {
 public:
-    // Construct a cache with the specified transaction count limit.
+    /// The approximate cached size of one unspent transaction, in bytes.
+    /// This converts a capacity configured in transactions to bytes.
+    static const size_t transaction_bytes;
+
+    /// Construct a cache with the specified (approximate) byte limit.
     unspent_outputs(size_t capacity);
 
     /// The cache capacity is zero.
@@ -47,7 +52,7 @@ public:
     /// The cache has no elements.
     size_t empty() const;
 
-    /// The number of elements in the cache.
+    /// The number of elements (transactions) in the cache.
     size_t size() const;
 
     /// The cache performance as a ratio of hits to accesses.
@@ -67,22 +72,54 @@ public:
     bool populate(const system::chain::output_point& point,
         size_t fork_height=max_size_t) const;
 
+    /// Write confirmed entries to file, tagged with the confirmed top hash.
+    bool save(const boost::filesystem::path& file,
+        const system::hash_digest& top) const;
+
+    /// Add entries from file, false if missing, invalid or not of top hash.
+    bool load(const boost::filesystem::path& file,
+        const system::hash_digest& top);
+
 private:
-    // A bidirection map is used for efficient output and position retrieval.
-    // This produces the effect of a circular buffer tx hash table of outputs.
-    typedef boost::bimaps::bimap<
-        boost::bimaps::unordered_set_of<unspent_transaction>,
-        boost::bimaps::set_of<uint32_t>> unspent_transactions;
+    struct entry
+    {
+        entry(unspent_transaction&& unspent, size_t bytes);
+
+        unspent_transaction unspent;
+        size_t bytes;
+
+        // Set by readers under shared lock, cleared by the clock hand.
+        mutable std::atomic<bool> referenced;
+    };
+
+    // The list is a ring swept by the hand, new entries precede the hand.
+    typedef std::list<entry> entries;
+    typedef std::unordered_map<system::hash_digest, entries::iterator> index;
+
+    struct shard
+    {
+        size_t bytes = 0;
+        entries ring;
+        entries::iterator hand = ring.end();
+        index hashes;
+        mutable system::upgrade_mutex mutex;
+    };
+
+    static const size_t shards = 16;
+
+    static void erase(shard& shard, entries::iterator it);
+
+    void insert(unspent_transaction&& unspent);
+
+    shard& get_shard(const system::hash_digest& tx_hash) const;
 
     // These are thread safe.
     const size_t capacity_;
     mutable std::atomic<size_t> hits_;
     mutable std::atomic<size_t> queries_;
 
-    // These are protected by mutex.
-    uint32_t sequence_;
-    unspent_transactions unspent_;
-    mutable system::upgrade_mutex mutex_;
+    // Each shard is protected by its own mutex.
+    mutable std::array<shard, shards> shards_;
 };
 
 } // namespace database
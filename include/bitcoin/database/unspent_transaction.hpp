@@ -21,8 +21,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <memory>
-#include <unordered_map>
 #include <boost/functional/hash_fwd.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
@@ -31,12 +29,11 @@ namespace libbitcoin {
 namespace database {
 
 /// This class is not thread safe.
+/// Outputs are packed into a single allocation of the form:
+/// [spent bitmap][offset:4 per output][value:8, script:compressed per output]
 class BCD_API unspent_transaction
 {
 public:
-    typedef std::unordered_map<uint32_t, system::chain::output> output_map;
-    typedef std::shared_ptr<output_map> output_map_ptr;
-
     // Move/copy constructors.
     unspent_transaction(unspent_transaction&& other);
     unspent_transaction(const unspent_transaction& other);
@@ -54,8 +51,24 @@ public:
     bool is_confirmed() const;
     const system::hash_digest& hash() const;
 
-    /// Access to outputs is mutable and unprotected (not thread safe).
-    output_map_ptr outputs() const;
+    /// The number of unspent outputs.
+    size_t size() const;
+
+    /// There are no unspent outputs.
+    bool empty() const;
+
+    /// The heap allocation of the outputs.
+    size_t bytes() const;
+
+    /// Populate the output at the index if it exists and is unspent.
+    bool populate(system::chain::output& out_output, uint32_t index) const;
+
+    /// Mark the output at the index spent, false if not unspent.
+    bool spend(uint32_t index);
+
+    /// Serialization (for cache snapshot).
+    void to_data(system::writer& sink) const;
+    bool from_data(system::reader& source);
 
     /// Operators.
     bool operator==(const unspent_transaction& other) const;
@@ -63,6 +76,7 @@ public:
     unspent_transaction& operator=(const unspent_transaction& other);
 
 private:
+    bool is_spent(uint32_t index) const;
 
     // These are thread safe (non-const only for assignment operator).
     size_t height_;
@@ -71,9 +85,10 @@ private:
     bool is_confirmed_;
     system::hash_digest hash_;
 
-    // This is not thread safe and is publicly reachable.
-    // The outputs can be changed without affecting the bimapping.
-    mutable output_map_ptr outputs_;
+    // These are not thread safe, the spent bitmap is changed by spend.
+    uint32_t count_;
+    uint32_t unspent_;
+    mutable system::data_chunk outputs_;
 };
 
 } // namespace database
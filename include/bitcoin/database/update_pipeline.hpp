@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_UPDATE_PIPELINE_HPP
+#define LIBBITCOIN_DATABASE_UPDATE_PIPELINE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/data_base.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// Updates downloaded blocks (in any order) on a pool of threads and hands
+/// each off to the completion handler in height order, one at a time. The
+/// handler is the in-order stage, such as candidate and confirm.
+/// If more than limit updates are held awaiting a missing height, that height
+/// is completed with error::operation_failed (and a null block). An update
+/// at a height already completed or held is completed out of order with
+/// error::operation_failed, though its block has been updated.
+class BCD_API update_pipeline
+  : system::noncopyable
+{
+public:
+    typedef std::function<void(const system::code&,
+        system::block_const_ptr, size_t)> handler;
+
+    /// Start the specified number of threads, with the first expected height.
+    update_pipeline(data_base& database, size_t first_height, size_t threads,
+        size_t limit, handler complete);
+
+    /// Stop the pipeline, completing any queued updates.
+    ~update_pipeline();
+
+    /// Queue the block for update, false if the pipeline is stopped.
+    bool enqueue(system::block_const_ptr block, size_t height);
+
+    /// Complete queued updates and join threads (idempotent).
+    /// Updates still awaiting a missing height complete with service_stopped.
+    void stop();
+
+private:
+    typedef std::pair<system::block_const_ptr, size_t> item;
+    typedef std::pair<system::code, system::block_const_ptr> result;
+
+    void work();
+    void release(const system::code& ec, system::block_const_ptr block,
+        size_t height);
+
+    data_base& database_;
+    const size_t limit_;
+    const handler complete_;
+    std::vector<std::thread> threads_;
+
+    // Protected by queue_mutex_.
+    bool stopped_;
+    std::deque<item> queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_condition_;
+
+    // Protected by ready_mutex_, released by one thread at a time.
+    size_t next_;
+    bool releasing_;
+    std::map<size_t, result> ready_;
+    std::deque<std::pair<result, size_t>> rejected_;
+    std::mutex ready_mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
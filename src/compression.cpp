@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/compression.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// Script format (v4):
+// ----------------------------------------------------------------------------
+// [ tag:varint ]
+// [ payload    ] (hash or key if template, otherwise the full script)
+
+// Templates:
+// ----------------------------------------------------------------------------
+// 0 [ dup hash160 [hash:20] equalverify checksig ] (pay key hash)
+// 1 [ hash160 [hash:20] equal ]                    (pay script hash)
+// 2 [ 0 [hash:20] ]                                (pay witness key hash)
+// 3 [ 0 [hash:32] ]                                (pay witness script hash)
+// 4 [ 1 [key:32] ]                                 (pay taproot)
+
+struct script_template
+{
+    data_chunk prefix;
+    size_t payload;
+    data_chunk suffix;
+};
+
+static const script_template templates[]
+{
+    { { 0x76, 0xa9, 0x14 }, short_hash_size, { 0x88, 0xac } },
+    { { 0xa9, 0x14 }, short_hash_size, { 0x87 } },
+    { { 0x00, 0x14 }, short_hash_size, {} },
+    { { 0x00, 0x20 }, hash_size, {} },
+    { { 0x51, 0x20 }, hash_size, {} }
+};
+
+const size_t script_templates = sizeof(templates) / sizeof(templates[0]);
+
+// Returns script_templates if the script does not match a template.
+static size_t to_tag(const data_chunk& script)
+{
+    for (size_t tag = 0; tag < script_templates; ++tag)
+    {
+        const auto& form = templates[tag];
+        const auto fixed = form.prefix.size() + form.suffix.size();
+
+        if (script.size() == fixed + form.payload &&
+            std::equal(form.prefix.begin(), form.prefix.end(),
+                script.begin()) &&
+            std::equal(form.suffix.begin(), form.suffix.end(),
+                script.end() - form.suffix.size()))
+            return tag;
+    }
+
+    return script_templates;
+}
+
+size_t compressed_size(const chain::script& script)
+{
+    const auto data = script.to_data(false);
+    const auto tag = to_tag(data);
+
+    if (tag < script_templates)
+        return sizeof(uint8_t) + templates[tag].payload;
+
+    return message::variable_uint_size(script_templates + data.size()) +
+        data.size();
+}
+
+void compress(byte_serializer& serial, const chain::script& script)
+{
+    const auto data = script.to_data(false);
+    const auto tag = to_tag(data);
+
+    if (tag < script_templates)
+    {
+        const auto start = data.begin() + templates[tag].prefix.size();
+        serial.write_size_little_endian(tag);
+        serial.write_bytes(&(*start), templates[tag].payload);
+        return;
+    }
+
+    serial.write_size_little_endian(script_templates + data.size());
+    serial.write_bytes(data);
+}
+
+chain::script decompress(byte_deserializer& deserial)
+{
+    const auto tag = deserial.read_size_little_endian();
+
+    if (tag >= script_templates)
+        return script::factory(deserial.read_bytes(tag - script_templates),
+            false);
+
+    const auto& form = templates[tag];
+    const auto payload = deserial.read_bytes(form.payload);
+    return script::factory(build_chunk({ form.prefix, payload, form.suffix }),
+        false);
+}
+
+size_t decompress(writer& sink, uint8_t* data)
+{
+    auto deserial = make_unsafe_deserializer(data);
+    const auto tag = deserial.read_size_little_endian();
+    const auto tag_size = message::variable_uint_size(tag);
+
+    if (tag >= script_templates)
+    {
+        const auto size = tag - script_templates;
+        sink.write_size_little_endian(size);
+        sink.write_bytes(data + tag_size, size);
+        return tag_size + size;
+    }
+
+    // The template is written about the payload as on the wire.
+    const auto& form = templates[tag];
+    sink.write_size_little_endian(form.prefix.size() + form.payload +
+        form.suffix.size());
+    sink.write_bytes(form.prefix);
+    sink.write_bytes(data + tag_size, form.payload);
+    sink.write_bytes(form.suffix);
+    return tag_size + form.payload;
+}
+
+size_t skip_compressed(byte_deserializer& deserial)
+{
+    const auto tag = deserial.read_size_little_endian();
+    const auto payload = tag < script_templates ? templates[tag].payload :
+        tag - script_templates;
+
+    deserial.skip(payload);
+    return message::variable_uint_size(tag) + payload;
+}
+
+size_t skip_compressed(byte_serializer& serial)
+{
+    const auto tag = serial.read_size_little_endian();
+    const auto payload = tag < script_templates ? templates[tag].payload :
+        tag - script_templates;
+
+    serial.skip(payload);
+    return message::variable_uint_size(tag) + payload;
+}
+
+// Templates are spendable. Otherwise as script::is_unspendable, from the first
+// operation code and the script size.
+size_t skip_compressed(byte_deserializer& deserial, bool& unspendable)
+{
+    const auto tag = deserial.read_size_little_endian();
+    const auto tag_size = message::variable_uint_size(tag);
+    unspendable = false;
+
+    if (tag < script_templates)
+    {
+        deserial.skip(templates[tag].payload);
+        return tag_size + templates[tag].payload;
+    }
+
+    const auto size = tag - script_templates;
+
+    if (size == 0)
+        return tag_size;
+
+    const auto code = static_cast<opcode>(deserial.read_byte());
+    deserial.skip(size - 1u);
+    unspendable = code == opcode::return_ || size > max_script_size;
+    return tag_size + size;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -19,14 +19,23 @@
 #include <bitcoin/database/data_base.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/metrics.hpp>
 #include <bitcoin/database/result/block_result.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
@@ -53,7 +62,56 @@ using namespace bc::system::wallet;
 // Could make index optional, redirecting queries if not present.
 
 // A failure after begin_write is returned without calling end_write.
-// This leaves the local flush lock enabled, preventing usage after restart.
+// This leaves the flush lock and journal, so the write is undone on restart.
+
+// Brackets a chain write, invalidating read snapshots that overlap it.
+// Writers are counted as candidate and invalidate may run concurrently.
+class write_guard
+{
+public:
+    write_guard(std::atomic<size_t>& writers, std::atomic<size_t>& sequence)
+      : writers_(writers), sequence_(sequence)
+    {
+        ++writing();
+        ++writers_;
+        ++sequence_;
+    }
+
+    ~write_guard()
+    {
+        ++sequence_;
+        --writers_;
+        --writing();
+    }
+
+    // The guards held by this thread (a read within a write never completes).
+    static size_t& writing()
+    {
+        static thread_local size_t guards = 0;
+        return guards;
+    }
+
+private:
+    std::atomic<size_t>& writers_;
+    std::atomic<size_t>& sequence_;
+};
+
+// A reader yields while a write is in progress, then sleeps for an interval
+// that doubles with each attempt up to 1024 microseconds.
+static void back_off(size_t attempts)
+{
+    static constexpr size_t yields = 4;
+    static constexpr size_t max_shift = 10;
+
+    if (attempts <= yields)
+    {
+        std::this_thread::yield();
+        return;
+    }
+
+    const auto shift = std::min(attempts - yields, max_shift);
+    std::this_thread::sleep_for(std::chrono::microseconds(size_t(1) << shift));
+}
 
 // Construct.
 // ----------------------------------------------------------------------------
@@ -63,8 +121,16 @@ data_base::data_base(const settings& settings, bool catalog, bool filter)
     catalog_(catalog),
     filter_(filter),
     settings_(settings),
+    write_sequence_(0),
+    active_writers_(0),
+    filter_ready_(false),
+    timing_(),
+    writer_stopped_(true),
+    workers_stopped_(true),
     database::store(settings.directory, catalog, filter_, settings.flush_writes)
 {
+    start_workers();
+
     LOG_DEBUG(LOG_DATABASE)
         << "Buckets: "
         << "block [" << settings.block_table_buckets << "], "
@@ -75,6 +141,7 @@ data_base::data_base(const settings& settings, bool catalog, bool filter)
 data_base::~data_base()
 {
     close();
+    stop_workers();
 }
 
 // Open and close.
@@ -108,6 +175,10 @@ bool data_base::create(const block& genesis)
     if (!created)
         return false;
 
+    // The genesis block has no filter checkpoint.
+    filter_ready_ = filter_;
+
+    start_writer();
     closed_ = false;
     return created;
 }
@@ -116,26 +187,52 @@ bool data_base::create(const block& genesis)
 // May be called after stop and/or after close in order to reopen.
 bool data_base::open()
 {
+    const auto start_time = std::chrono::steady_clock::now();
+
     ///////////////////////////////////////////////////////////////////////////
     // Lock exclusive file access and conditionally the global flush lock.
     if (!store::open())
         return false;
 
+    const auto locked_time = std::chrono::steady_clock::now();
     start();
 
-    auto opened = blocks_->open() && transactions_->open();
+    if (!open_tables())
+        return false;
 
-    if (filter_)
-        opened &= filters_->open() && populate_filter_cache(*filters_);
+    const auto opened_time = std::chrono::steady_clock::now();
+    populate_output_cache();
+    const auto cached_time = std::chrono::steady_clock::now();
 
-    if (catalog_)
-        opened &= payments_->open();
+    open_timing timing;
+    timing.lock = std::chrono::duration_cast<std::chrono::microseconds>(
+        locked_time - start_time);
+    timing.tables = std::chrono::duration_cast<std::chrono::microseconds>(
+        opened_time - locked_time);
+    timing.output_cache = std::chrono::duration_cast<std::chrono::microseconds>(
+        cached_time - opened_time);
+    timing.filter_checkpoints = std::chrono::microseconds(0);
 
-    if (!opened)
-        return false;
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(timing_mutex_);
+        timing_ = timing;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    LOG_INFO(LOG_DATABASE)
+        << "Opened store, lock: " << timing.lock.count()
+        << " us, tables: " << timing.tables.count()
+        << " us, output cache: " << timing.output_cache.count() << " us.";
+
+    // Filter checkpoints are not required to serve, so are populated after.
+    if (filter_)
+        start_filter_loader();
 
+    start_writer();
     closed_ = false;
-    return opened;
+    return true;
 }
 
 // TODO: simplify interface by passing settings reference to databases.
@@ -158,10 +255,17 @@ void data_base::start()
 
     transactions_ = std::make_shared<transaction_database>(
         transaction_table,
+        witness_table,
+        utxo_table,
         settings_.transaction_table_size,
+        settings_.witness_table_size,
+        settings_.utxo_table_size,
         settings_.transaction_table_buckets,
+        settings_.utxo_table_buckets,
         settings_.file_growth_rate,
-        settings_.cache_capacity);
+        ceiling_multiply<size_t>(settings_.cache_capacity,
+            unspent_outputs::transaction_bytes),
+        settings_.transaction_cache_capacity);
 
     if (filter_)
     {
@@ -183,6 +287,16 @@ void data_base::start()
             settings_.payment_table_buckets,
             settings_.file_growth_rate);
     }
+
+    // In-place writes are journaled for rollback of an interrupted write.
+    blocks_->set_journal(write_journal());
+    transactions_->set_journal(write_journal());
+
+    if (filter_)
+        filters_->set_journal(write_journal());
+
+    if (catalog_)
+        payments_->set_journal(write_journal());
 }
 
 // protected
@@ -208,6 +322,7 @@ bool data_base::flush() const
     ////if (closed_)
     ////    return true;
 
+    const metrics::timer measure(metrics_, metrics::flush);
     auto flushed = blocks_->flush() && transactions_->flush();
 
     if (filter_)
@@ -230,7 +345,12 @@ bool data_base::close()
     if (closed_)
         return true;
 
+    // Queued writes are completed before the tables are closed.
+    stop_writer();
+    stop_filter_loader();
+
     closed_ = true;
+    save_output_cache();
 
     auto closed = blocks_->close() && transactions_->close();
 
@@ -245,6 +365,102 @@ bool data_base::close()
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// private
+// Tables are independent files, so they are mapped and loaded concurrently.
+bool data_base::open_tables()
+{
+    std::vector<std::function<bool()>> opens
+    {
+        [this]() { return blocks_->open(); },
+        [this]() { return transactions_->open(); }
+    };
+
+    if (filter_)
+        opens.push_back([this]() { return filters_->open(); });
+
+    if (catalog_)
+        opens.push_back([this]() { return payments_->open(); });
+
+    // Each worker writes only its own result.
+    std::vector<uint8_t> opened(opens.size(), 0);
+
+    parallel(opens.size(), [&](size_t index)
+    {
+        opened[index] = opens[index]() ? 1 : 0;
+    });
+
+    return std::all_of(opened.begin(), opened.end(), [](uint8_t value)
+    {
+        return value != 0;
+    });
+}
+
+// private
+void data_base::start_filter_loader()
+{
+    filter_ready_ = false;
+    filter_loader_ = std::thread([this]()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        const auto ec = populate_filter_cache(*filters_);
+
+        // Population is retried by the next filter cache update.
+        if (ec)
+        {
+            LOG_ERROR(LOG_DATABASE)
+                << "Failed to populate neutrino filter checkpoints: "
+                << ec.message();
+            return;
+        }
+
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(timing_mutex_);
+            timing_.filter_checkpoints = elapsed;
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        filter_ready_ = true;
+
+        LOG_INFO(LOG_DATABASE)
+            << "Populated neutrino filter checkpoints in " << elapsed.count()
+            << " us.";
+    });
+}
+
+// private
+// The loader completes before close, and before checkpoints are updated.
+void data_base::stop_filter_loader()
+{
+    if (filter_loader_.joinable())
+        filter_loader_.join();
+}
+
+data_base::open_timing data_base::startup_timing() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(timing_mutex_);
+    return timing_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool data_base::filter_checkpoints_ready() const
+{
+    return filter_ready_;
+}
+
+metrics::report data_base::metrics_report() const
+{
+    return metrics_.snapshot();
+}
+
 // Reader interfaces.
 // ----------------------------------------------------------------------------
 // public
@@ -271,6 +487,139 @@ const payment_database& data_base::payments() const
     return *payments_;
 }
 
+// Read snapshots.
+// ----------------------------------------------------------------------------
+// A snapshot never blocks writers and readers never take the write mutex.
+
+data_base::read_snapshot data_base::begin_read() const
+{
+    read_snapshot snapshot{ write_sequence_.load(), 0, 0 };
+
+    // Records are append-only, so any state below the tops remains readable.
+    blocks_->top(snapshot.candidate_height, true);
+    blocks_->top(snapshot.confirmed_height, false);
+    return snapshot;
+}
+
+bool data_base::is_current(const read_snapshot& snapshot) const
+{
+    return active_writers_.load() == 0 &&
+        write_sequence_.load() == snapshot.sequence;
+}
+
+// The query is repeated until it completes without an overlapping write.
+// This must not be called by a thread within a write (holding write_guard),
+// as it would await the end of its own write.
+void data_base::read(const read_handler& query) const
+{
+    BITCOIN_ASSERT_MSG(write_guard::writing() == 0, "Read within a write.");
+    metrics::timer measure(metrics_, metrics::read);
+
+    for (size_t attempts = 1; ; ++attempts)
+    {
+        // The sequence is read before the writer count (see write_guard).
+        const auto snapshot = begin_read();
+
+        if (active_writers_.load() != 0)
+        {
+            back_off(attempts);
+            continue;
+        }
+
+        query(snapshot);
+
+        if (is_current(snapshot))
+        {
+            measure.set_units(attempts);
+            return;
+        }
+    }
+}
+
+// Serving.
+// ----------------------------------------------------------------------------
+
+// This walks the tx index of the block, avoiding construction of the block.
+bool data_base::block_data(writer& sink, const block_result& result,
+    bool witness) const
+{
+    // The txs of a pruned block may not be retained.
+    if (!result || result.pruned())
+        return false;
+
+    result.header().to_data(sink, true);
+    sink.write_size_little_endian(result.transaction_count());
+
+    for (const auto link: result)
+    {
+        const auto tx = transactions_->get(link);
+
+        if (!tx || !tx.to_data(sink, witness))
+            return false;
+    }
+
+    return sink;
+}
+
+data_chunk data_base::block_data(const block_result& result,
+    bool witness) const
+{
+    data_chunk data;
+    data_sink ostream(data);
+    ostream_writer sink(ostream);
+
+    if (!block_data(sink, result, witness))
+        return {};
+
+    ostream.flush();
+    return data;
+}
+
+// Prevout prefetch.
+// ----------------------------------------------------------------------------
+
+std::chrono::microseconds data_base::populate_prevouts(const block& block,
+    size_t fork_height) const
+{
+    typedef transaction_database::point_group point_group;
+    const auto start = std::chrono::steady_clock::now();
+    metrics::timer measure(metrics_, metrics::prefetch, 0);
+
+    // Group the prevouts by tx, so that each tx is found only once.
+    std::unordered_map<hash_digest, point_group> groups;
+
+    for (const auto& tx: block.transactions())
+        for (const auto& input: tx.inputs())
+            if (!input.previous_output().is_null())
+                groups[input.previous_output().hash()].push_back(
+                    &input.previous_output());
+
+    std::vector<const point_group*> work;
+    work.reserve(groups.size());
+
+    for (const auto& group: groups)
+        work.push_back(&group.second);
+
+    const auto count = std::min(work.size(), workers_.size() + 1u);
+
+    // Groups are disjoint, so workers populate metadata without contention.
+    parallel(count, [&](size_t offset)
+    {
+        for (auto index = offset; index < work.size(); index += count)
+            transactions_->get_outputs(*work[index], fork_height);
+    });
+
+    measure.set_units(work.size());
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    LOG_DEBUG(LOG_DATABASE)
+        << "Populated " << work.size() << " prevout txs in "
+        << elapsed.count() << " us.";
+
+    return elapsed;
+}
+
 // Public writers.
 // ----------------------------------------------------------------------------
 
@@ -284,7 +633,9 @@ code data_base::catalog(const transaction& tx)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::catalog);
     conditional_lock lock(flush_each_write());
+    measure.locked();
 
     if ((ec = verify_exists(*transactions_, tx)))
         return ec;
@@ -308,6 +659,8 @@ code data_base::catalog(const block& block)
     if (!catalog_)
         return ec;
 
+    const metrics::timer measure(metrics_, metrics::catalog_block,
+        block.transactions().size());
     const auto start = asio::steady_clock::now();
 
     // Existence checks prevent duplicated indexing.
@@ -322,12 +675,13 @@ code data_base::catalog(const block& block)
 }
 
 // Called from candidate and push.
-system::code data_base::filter(const block& block)
+system::code data_base::filter(const block& block, array_index link)
 {
     code ec;
     if (!filter_)
         return ec;
 
+    const metrics::timer measure(metrics_, metrics::filter);
     const auto start = asio::steady_clock::now();
 
     const auto neutrino_filter = block.header().metadata.neutrino_filter;
@@ -335,8 +689,8 @@ system::code data_base::filter(const block& block)
     if (!neutrino_filter)
         return error::operation_failed;
 
-    const auto link = neutrino_filter->metadata.link;
-    const auto exists = link != block_filter::validation::unlinked;
+    const auto filter_link = neutrino_filter->metadata.link;
+    const auto exists = filter_link != block_filter::validation::unlinked;
 
     // Existence check prevents duplicated indexing.
     if (!exists)
@@ -344,7 +698,7 @@ system::code data_base::filter(const block& block)
         if (!filters_->store(*neutrino_filter))
             return error::operation_failed;
 
-        if (!blocks_->update_neutrino_filter(block.hash(), link))
+        if (!blocks_->update_neutrino_filter(link, filter_link))
             return error::operation_failed;
     }
 
@@ -360,7 +714,9 @@ code data_base::store(const transaction& tx, uint32_t forks)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::store);
     conditional_lock lock(flush_each_write());
+    measure.locked();
 
     // Returns error::duplicate_transaction if tx with same hash exists.
     if ((ec = verify_missing(*transactions_, tx)))
@@ -390,6 +746,12 @@ code data_base::reorganize(const config::checkpoint& fork_point,
     if (fork_point.height() > max_size_t - incoming->size())
         return error::operation_failed;
 
+    const metrics::timer measure(metrics_, metrics::reorganize_headers,
+        incoming->size());
+
+    // Readers are invalidated across the pop and push of a reorganization.
+    const write_guard guard(active_writers_, write_sequence_);
+
     const auto result =
         pop_above(outgoing, fork_point) &&
         push_all(incoming, fork_point);
@@ -397,28 +759,22 @@ code data_base::reorganize(const config::checkpoint& fork_point,
     return result ? error::success : error::operation_failed;
 }
 
+// A single confirmation is a batch of one, so it is locked and committed.
+// This takes the write mutex and begins and ends a write for each block.
 code data_base::confirm(const hash_digest& block_hash, size_t height)
 {
-    code ec;
-
-    if ((ec = verify_confirm(*blocks_, block_hash, height)))
-        return error::operation_failed;
-
-    const auto block = blocks().get(block_hash);
-    const auto time = block.median_time_past();
-    size_t position = 0;
-
-    // Mark block txs as confirmed without reading transactions.
-    for (const auto tx_offset: block)
-        if (!transactions_->confirm(tx_offset, height, time, position++))
-            return error::operation_failed;
-
-    // TODO: optimize using link.
-    // Promote block to confirmed.
-    if (!blocks_->promote(block_hash, height, false))
-        return error::operation_failed;
+    return confirm(hash_list{ block_hash }, height);
+}
 
-    return error::success;
+// Group commit of a contiguous range of validated candidate blocks.
+// The flush lock spans the batch, so a crash within it is detected as a
+// corrupted store at next start, just as with a crash within one block.
+// The blocks are verified before the write, so an invalid block writes
+// nothing, and a failure within the write leaves the store to be recovered.
+code data_base::confirm(const hash_list& block_hashes, size_t first_height)
+{
+    size_t confirmed;
+    return confirm(block_hashes, first_height, false, confirmed);
 }
 
 // Add missing transactions for an existing block header.
@@ -429,7 +785,9 @@ code data_base::update(const chain::block& block, size_t height)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::update);
     conditional_lock lock(flush_each_write());
+    measure.locked();
 
     const auto start = asio::steady_clock::now();
     if ((ec = verify_update(*blocks_, block, height)))
@@ -467,7 +825,10 @@ code data_base::invalidate(const header& header, const code& error)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::invalidate);
     conditional_lock lock(flush_each_write());
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     if ((ec = verify_exists(*blocks_, header)))
         return ec;
@@ -493,7 +854,10 @@ code data_base::candidate(const block& block)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::candidate);
     conditional_lock lock(flush_each_write());
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     const auto start = asio::steady_clock::now();
     if ((ec = verify_not_failed(*blocks_, block)))
@@ -502,12 +866,20 @@ code data_base::candidate(const block& block)
     const auto& header = block.header();
     BITCOIN_ASSERT(!header.metadata.error);
 
+    // The block is found once, its link is used for each update.
+    const auto result = blocks_->get(header.hash());
+
+    if (!result)
+        return error::not_found;
+
+    const auto link = result.link();
+
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
     // Set candidate validation state to valid.
-    if (!blocks_->validate(header.hash(), error::success))
+    if (!blocks_->validate(link, error::success))
         return error::operation_failed;
 
     // Mark candidate block txs and outputs spent by them as candidate.
@@ -515,7 +887,7 @@ code data_base::candidate(const block& block)
         if (!transactions_->candidate(tx.metadata.link))
             return error::operation_failed;
 
-    if ((ec = filter(block)))
+    if ((ec = filter(block, link)))
         return ec;
 
     if ((ec = catalog(block)))
@@ -531,6 +903,7 @@ code data_base::candidate(const block& block)
 
 // Reorganize blocks.
 // Header metadata median_time_past must be set on all incoming blocks.
+// Outgoing blocks are deconfirmed by tx link, and only read if requested.
 code data_base::reorganize(const config::checkpoint& fork_point,
     block_const_ptr_list_const_ptr incoming,
     block_const_ptr_list_ptr outgoing)
@@ -538,15 +911,34 @@ code data_base::reorganize(const config::checkpoint& fork_point,
     if (fork_point.height() > max_size_t - incoming->size())
         return error::operation_failed;
 
-    const auto result =
-        pop_above(outgoing, fork_point) &&
-        push_all(incoming, fork_point);
+    size_t top;
+    if (!blocks_->top(top, false) || top < fork_point.height())
+        return error::operation_failed;
+
+    // Pruned blocks cannot be deconfirmed, as their txs cannot be read.
+    if (is_pruned_fork(fork_point.height(), top))
+        return error::operation_failed;
+
+    const metrics::timer measure(metrics_, metrics::reorganize_blocks,
+        incoming->size());
+
+    // Readers are invalidated across the pop and push of a reorganization.
+    // The guard is released before the filter cache is updated, as that may
+    // await (or retry) the checkpoint load, which reads only between writes.
+    auto result = false;
+    {
+        const write_guard guard(active_writers_, write_sequence_);
+        result =
+            pop_above(outgoing, fork_point) &&
+            push_all(incoming, fork_point);
+    }
 
     if (!result)
         return error::operation_failed;
 
     if (filter_)
-        return update_filter_cache(*filters_, fork_point, incoming, outgoing);
+        return update_filter_cache(*filters_, fork_point, incoming,
+            top - fork_point.height());
 
     return error::success;
 }
@@ -559,17 +951,20 @@ code data_base::push(const block& block, size_t height,
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::push);
     unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
-    // Store the header.
-    blocks_->store(block.header(), height, median_time_past);
+    // Store the header, retaining its link for subsequent state changes.
+    const auto link = blocks_->store(block.header(), height, median_time_past);
 
     // Push header reference onto the candidate index and set candidate state.
-    if (!blocks_->promote(block.hash(), height, true))
+    if (!blocks_->promote(link, height, true))
         return error::operation_failed;
 
     // Store any missing txs as unconfirmed, set tx link metadata for all.
@@ -577,7 +972,7 @@ code data_base::push(const block& block, size_t height,
         return error::operation_failed;
 
     // Populate transaction references from link metadata.
-    if (!blocks_->update_transactions(block))
+    if (!blocks_->update_transactions(link, block))
         return error::operation_failed;
 
     // Confirm all transactions (candidate state transition not requried).
@@ -585,48 +980,407 @@ code data_base::push(const block& block, size_t height,
         return error::operation_failed;
 
     // Promote validation state to valid (presumed valid).
-    if (!blocks_->validate(block.hash(), error::success))
+    if (!blocks_->validate(link, error::success))
         return error::operation_failed;
 
-    if ((ec = filter(block)))
+    if ((ec = filter(block, link)))
         return ec;
 
     if ((ec = catalog(block)))
         return ec;
 
-    // TODO: optimize using link.
     // Push header reference onto the confirmed index and set confirmed state.
-    if (!blocks_->promote(block.hash(), height, false))
+    if (!blocks_->promote(link, height, false))
+        return error::operation_failed;
+
+    if (!prune(height))
         return error::operation_failed;
 
     blocks_->commit();
     transactions_->commit();
 
-    return end_write() ? error::success : error::store_lock_failure;
+    if (!end_write())
+        return error::store_lock_failure;
+
+    reclaim();
+    return error::success;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
 
-// Header reorganization.
-// ----------------------------------------------------------------------------
-// protected
+// private
+// If partial, the blocks that precede an invalid block are written and the
+// error of the invalid block is returned, otherwise nothing is written.
+code data_base::confirm(const hash_list& block_hashes, size_t first_height,
+    bool partial, size_t& confirmed)
+{
+    std::vector<block_result> blocks;
+    confirmed = 0;
 
-bool data_base::push_all(header_const_ptr_list_const_ptr headers,
-    const config::checkpoint& fork_point)
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::confirm, block_hashes.size());
+    unique_lock lock(write_mutex_);
+    measure.locked();
+
+    const auto ec = verify_confirms(blocks, block_hashes, first_height);
+
+    if (ec && (!partial || blocks.empty()))
+        return ec;
+
+    const write_guard guard(active_writers_, write_sequence_);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    auto height = first_height;
+
+    for (const auto& block: blocks)
+        if (!confirm(block, height++))
+            return error::operation_failed;
+
+    // Utxo table allocations are committed with the tx table.
+    blocks_->commit();
+    transactions_->commit();
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    confirmed = blocks.size();
+    reclaim();
+    return ec;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Populates the blocks that verify, up to the first that does not. The first
+// block must extend the confirmed top and each other the block before it.
+code data_base::verify_confirms(std::vector<block_result>& out_blocks,
+    const hash_list& block_hashes, size_t first_height) const
 {
     code ec;
-    const auto first_height = fork_point.height() + 1;
+    out_blocks.reserve(block_hashes.size());
 
-    // Push all headers onto the fork point.
-    for (size_t index = 0; index < headers->size(); ++index)
+    for (const auto& block_hash: block_hashes)
     {
-        const auto& header = *((*headers)[index]);
-        const auto median_time_past = header.metadata.median_time_past;
-        if ((ec = push_header(header, first_height + index, median_time_past)))
+        if (out_blocks.empty() &&
+            (ec = verify_confirm(*blocks_, block_hash, first_height)))
+            return ec;
+
+        auto block = blocks_->get(block_hash);
+
+        if (!block)
+            return error::not_found;
+
+        if (!out_blocks.empty() && block.header().previous_block_hash() !=
+            block_hashes[out_blocks.size() - 1])
+            return error::store_block_missing_parent;
+
+        out_blocks.push_back(std::move(block));
+    }
+
+    return error::success;
+}
+
+// Mark block txs as confirmed without reading transactions, then promote.
+bool data_base::confirm(const block_result& block, size_t height)
+{
+    if (!block)
+        return false;
+
+    const auto time = block.median_time_past();
+    size_t position = 0;
+
+    for (const auto tx_offset: block)
+        if (!transactions_->confirm(tx_offset, height, time, position++))
             return false;
+
+    // Promote block to confirmed, and prune below it.
+    return blocks_->promote(block.link(), height, false) && prune(height);
+}
+
+// Asynchronous writers.
+// ----------------------------------------------------------------------------
+// The block and transaction pointers are retained until the write completes.
+
+void data_base::push(block_const_ptr block, size_t height,
+    uint32_t median_time_past, result_handler handler)
+{
+    enqueue({ [=]() { return push(*block, height, median_time_past); },
+        handler, null_hash, height, false });
+}
+
+void data_base::update(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    enqueue({ [=]() { return update(*block, height); }, handler, null_hash,
+        height, false });
+}
+
+void data_base::candidate(block_const_ptr block, result_handler handler)
+{
+    enqueue({ [=]() { return candidate(*block); }, handler, null_hash, 0,
+        false });
+}
+
+void data_base::confirm(const hash_digest& block_hash, size_t height,
+    result_handler handler)
+{
+    enqueue({ [=]() { return confirm(block_hash, height); }, handler,
+        block_hash, height, true });
+}
+
+void data_base::store(transaction_const_ptr tx, uint32_t forks,
+    result_handler handler)
+{
+    enqueue({ [=]() { return store(*tx, forks); }, handler, null_hash, 0,
+        false });
+}
+
+void data_base::catalog(transaction_const_ptr tx, result_handler handler)
+{
+    enqueue({ [=]() { return catalog(*tx); }, handler, null_hash, 0, false });
+}
+
+size_t data_base::write_queue_depth() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(write_queue_mutex_);
+    return write_queue_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void data_base::enqueue(write_request&& request)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(write_queue_mutex_);
+
+        if (!writer_stopped_)
+        {
+            write_queue_.push_back(std::move(request));
+            write_queue_condition_.notify_one();
+            return;
+        }
     }
+    ///////////////////////////////////////////////////////////////////////////
 
-    return true;
+    request.handler(error::service_stopped);
+}
+
+// private
+void data_base::start_writer()
+{
+    writer_stopped_ = false;
+    writer_ = std::thread(&data_base::writer, this);
+}
+
+// private
+void data_base::stop_writer()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(write_queue_mutex_);
+        writer_stopped_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    write_queue_condition_.notify_one();
+
+    if (writer_.joinable())
+        writer_.join();
+}
+
+// private
+// The queue is drained on each wake, so writes that accumulate while the
+// writer is busy are completed together. The queue is emptied before exit.
+void data_base::writer()
+{
+    while (true)
+    {
+        write_queue requests;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(write_queue_mutex_);
+            write_queue_condition_.wait(lock, [this]()
+            {
+                return writer_stopped_ || !write_queue_.empty();
+            });
+
+            if (write_queue_.empty())
+                return;
+
+            requests.swap(write_queue_);
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        write_all(requests);
+    }
+}
+
+// private
+// The pool persists for the life of the instance, across open and close.
+void data_base::start_workers()
+{
+    const auto count = std::max(std::thread::hardware_concurrency(), 1u);
+    workers_stopped_ = false;
+    workers_.reserve(count);
+
+    for (size_t thread = 0; thread < count; ++thread)
+        workers_.emplace_back(&data_base::worker, this);
+}
+
+// private
+void data_base::stop_workers()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(work_mutex_);
+        workers_stopped_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    work_condition_.notify_all();
+
+    for (auto& thread: workers_)
+        if (thread.joinable())
+            thread.join();
+}
+
+// private
+// Workers drain the queue before exiting on stop.
+void data_base::worker() const
+{
+    while (true)
+    {
+        std::function<void()> work;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(work_mutex_);
+            work_condition_.wait(lock, [this]()
+            {
+                return workers_stopped_ || !work_queue_.empty();
+            });
+
+            if (work_queue_.empty())
+                return;
+
+            work = std::move(work_queue_.front());
+            work_queue_.pop_front();
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        work();
+    }
+}
+
+// private
+// Invokes work(offset) for each offset in [0, count) and returns on completion.
+// The calling thread performs offset zero, and all offsets if stopped.
+void data_base::parallel(size_t count, const work_handler& work) const
+{
+    if (count == 0)
+        return;
+
+    size_t pending = count - 1u;
+    std::mutex pending_mutex;
+    std::condition_variable pending_condition;
+
+    const auto complete = [&]()
+    {
+        // Notify under the lock, as the caller destroys the condition.
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        --pending;
+        pending_condition.notify_one();
+    };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(work_mutex_);
+
+        if (workers_stopped_)
+        {
+            lock.unlock();
+
+            for (size_t offset = 0; offset < count; ++offset)
+                work(offset);
+
+            return;
+        }
+
+        for (size_t offset = 1; offset < count; ++offset)
+            work_queue_.emplace_back([&, offset]()
+            {
+                work(offset);
+                complete();
+            });
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    work_condition_.notify_all();
+    work(0);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    pending_condition.wait(lock, [&]()
+    {
+        return pending == 0u;
+    });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// A run of confirmations at consecutive heights is written as one batch,
+// with one commit (and flush). The batch is split at a failed block, so
+// each handler receives the result of its own block.
+void data_base::write_all(write_queue& requests)
+{
+    for (auto it = requests.begin(); it != requests.end();)
+    {
+        if (!it->confirm)
+        {
+            it->handler(it->write());
+            ++it;
+            continue;
+        }
+
+        auto end = std::next(it);
+        hash_list hashes{ it->hash };
+
+        for (; end != requests.end() && end->confirm &&
+            end->height == it->height + hashes.size(); ++end)
+            hashes.push_back(end->hash);
+
+        size_t confirmed;
+        const auto ec = confirm(hashes, it->height, true, confirmed);
+
+        // Blocks that precede a failed block are confirmed.
+        for (size_t index = 0; it != end; ++it, ++index)
+            it->handler(index < confirmed ? error::success : ec);
+    }
+}
+
+// Header reorganization.
+// ----------------------------------------------------------------------------
+// protected
+
+bool data_base::push_all(header_const_ptr_list_const_ptr headers,
+    const config::checkpoint& fork_point)
+{
+    // Push all headers onto the fork point.
+    return !push_headers(*headers, fork_point.height() + 1);
 }
 
 bool data_base::pop_above(header_const_ptr_list_ptr headers,
@@ -669,7 +1423,10 @@ code data_base::push_header(const chain::header& header, size_t height,
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::push_headers);
     unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     if ((ec = verify_push(*blocks_, header, height)))
         return ec;
@@ -678,11 +1435,46 @@ code data_base::push_header(const chain::header& header, size_t height,
     if (!begin_write())
         return error::store_lock_failure;
 
-    if (!header.metadata.exists)
+    const auto link = header.metadata.exists ?
+        blocks_->get(header.hash()).link() :
         blocks_->store(header, height, median_time_past);
 
-    // TODO: optimize using link.
-    blocks_->promote(header.hash(), height, true);
+    blocks_->promote(link, height, true);
+    blocks_->commit();
+
+    return end_write() ? error::success : error::store_lock_failure;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Expects headers are next candidates and metadata.exists is populated.
+// Median time past metadata is populated when the block is validated.
+// The batch is written under one write transaction with one commit.
+code data_base::push_headers(const header_const_ptr_list& headers,
+    size_t first_height)
+{
+    code ec;
+
+    if (headers.empty())
+        return error::success;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::push_headers, headers.size());
+    unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
+
+    if ((ec = verify_push(*blocks_, *headers.front(), first_height)))
+        return ec;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    if (!blocks_->store(headers, first_height))
+        return error::operation_failed;
+
     blocks_->commit();
 
     return end_write() ? error::success : error::store_lock_failure;
@@ -697,7 +1489,10 @@ code data_base::pop_header(chain::header& out_header, size_t height)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::pop_header);
     unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     if ((ec = verify_top(*blocks_, height, true)))
         return ec;
@@ -716,9 +1511,8 @@ code data_base::pop_header(chain::header& out_header, size_t height)
         if (!transactions_->uncandidate(link))
             return error::operation_failed;
 
-    // TODO: optimize using link.
     // Demote the candidate header.
-    if (!blocks_->demote(result.hash(), height, true))
+    if (!blocks_->demote(result.link(), height, true))
         return error::operation_failed;
 
     blocks_->commit();
@@ -752,11 +1546,14 @@ bool data_base::push_all(block_const_ptr_list_const_ptr blocks,
     return true;
 }
 
+// Blocks may be null, in which case the popped blocks are not read.
 bool data_base::pop_above(block_const_ptr_list_ptr blocks,
     const config::checkpoint& fork_point)
 {
     code ec;
-    blocks->clear();
+    if (blocks)
+        blocks->clear();
+
     if ((ec = verify(*blocks_, fork_point, false)))
         return false;
 
@@ -765,11 +1562,26 @@ bool data_base::pop_above(block_const_ptr_list_ptr blocks,
         return false;
 
     const auto fork = fork_point.height();
+    if (is_pruned_fork(fork, top))
+        return false;
+
     const auto depth = top - fork;
-    blocks->reserve(depth);
     if (depth == 0)
         return true;
 
+    // Pop all blocks above the fork point, deconfirming by tx link only.
+    if (!blocks)
+    {
+        hash_digest hash;
+        for (size_t height = top; height > fork; --height)
+            if ((ec = pop_block(hash, height)))
+                return false;
+
+        return true;
+    }
+
+    blocks->reserve(depth);
+
     // Pop all blocks above the fork point.
     for (size_t height = top; height > fork; --height)
     {
@@ -790,12 +1602,21 @@ code data_base::push_block(const block& block, size_t height)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::push_block);
     unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     const auto start = asio::steady_clock::now();
     if ((ec = verify_push(*blocks_, block, height)))
         return ec;
 
+    // The candidate block is found once, before the write.
+    const auto result = blocks_->get(block.hash());
+
+    if (!result)
+        return error::not_found;
+
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
@@ -804,107 +1625,228 @@ code data_base::push_block(const block& block, size_t height)
     if (!transactions_->confirm(block, height, median_time_past))
         return error::operation_failed;
 
-    // TODO: optimize using link.
     // Confirm candidate block (candidate index unchanged).
-    if (!blocks_->promote(block.hash(), height, false))
+    if (!blocks_->promote(result.link(), height, false))
+        return error::operation_failed;
+
+    if (!prune(height))
         return error::operation_failed;
 
+    // Utxo table allocations are committed with the tx table.
     blocks_->commit();
+    transactions_->commit();
 
     block.metadata.confirm = asio::steady_clock::now() - start;
-    return end_write() ? error::success : error::store_lock_failure;
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    reclaim();
+    return error::success;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// Block tx sets are permanent, so the popped block is read after the pop.
 code data_base::pop_block(chain::block& out_block, size_t height)
+{
+    code ec;
+    hash_digest hash;
+    if ((ec = pop_block(hash, height)))
+        return ec;
+
+    const auto result = blocks_->get(hash);
+
+    if (!result)
+        return error::operation_failed;
+
+    // Create a block for return, reading its txs outside of the write lock.
+    out_block = chain::block(result.header(), to_transactions(result));
+    BITCOIN_ASSERT(out_block.is_valid());
+    BITCOIN_ASSERT(out_block.hash() == hash);
+    return error::success;
+}
+
+// Deconfirm the top block by tx link, without reading its txs.
+code data_base::pop_block(hash_digest& out_hash, size_t height)
 {
     code ec;
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    metrics::timer measure(metrics_, metrics::pop_block);
     unique_lock lock(write_mutex_);
+    measure.locked();
+    const write_guard guard(active_writers_, write_sequence_);
 
     if ((ec = verify_top(*blocks_, height, false)))
         return ec;
 
     const auto result = blocks_->get(height, false);
 
-    if (!result)
+    // The prevouts of a pruned block's txs cannot be read to unspend them.
+    if (!result || result.pruned())
         return error::operation_failed;
 
-    // Create a block for walking transactions and return.
-    out_block = chain::block(result.header(), to_transactions(result));
-    BITCOIN_ASSERT(out_block.hash() == result.hash());
-
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
     // Deconfirm txs (and thereby also payment indexes), unspend prevouts.
-    if (!transactions_->unconfirm(out_block))
-        return error::operation_failed;
+    for (const auto link: result)
+        if (!transactions_->unconfirm(link))
+            return error::operation_failed;
 
-    // TODO: optimize using link.
     // Demote the confirmed block (candidate index unchanged).
-    if (!blocks_->demote(result.hash(), height, false))
+    if (!blocks_->demote(result.link(), height, false))
         return error::operation_failed;
 
+    // Utxo table allocations are committed with the tx table.
     blocks_->commit();
+    transactions_->commit();
 
-    BITCOIN_ASSERT(out_block.is_valid());
+    out_hash = result.hash();
     return end_write() ? error::success : error::store_lock_failure;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// This may run concurrently with writes, so the walk is repeated until it
+// reads a single confirmed chain.
 system::code data_base::populate_filter_cache(filter_database& database)
 {
     constexpr auto interval = compact_filter_checkpoint_interval;
-    size_t height = 0u;
-
-    if (!blocks().top(height, false))
-        return error::operation_failed;
-
+    code ec;
     hash_list checkpoints;
-    checkpoints.reserve(height / interval);
 
-    for (auto index = interval; index <= height;
-        index = ceiling_add(index, interval))
+    read([&](const read_snapshot& snapshot)
     {
-        const auto block_result = blocks().get(index, false);
+        const auto height = snapshot.confirmed_height;
+        ec = error::success;
+        checkpoints.clear();
+        checkpoints.reserve(height / interval);
 
-        if (!block_result)
-            return error::operation_failed;
+        for (auto index = interval; index <= height;
+            index = ceiling_add(index, interval))
+        {
+            block_database::index_entry entry;
 
-        const auto filter_result = database.get(
-            block_result.neutrino_filter());
+            if (!blocks().get(entry, index, false))
+            {
+                ec = error::operation_failed;
+                return;
+            }
 
-        if (!filter_result)
-            return error::operation_failed;
+            const auto filter_result = database.get(entry.neutrino_filter);
 
-        checkpoints.push_back(filter_result.header());
-    }
+            if (!filter_result)
+            {
+                ec = error::operation_failed;
+                return;
+            }
+
+            checkpoints.push_back(filter_result.header());
+        }
+    });
+
+    if (ec)
+        return ec;
 
     database.set_checkpoints(std::move(checkpoints));
     return error::success;
 }
 
+// The snapshot is removed once read, so it cannot outlive an unclean shutdown.
+// Otherwise the cache is warmed from the unspent outputs of the top blocks.
+void data_base::populate_output_cache()
+{
+    size_t top;
+    if (settings_.cache_capacity == 0 || !blocks_->top(top, false))
+        return;
+
+    block_database::index_entry entry;
+    if (!blocks_->get(entry, top, false))
+        return;
+
+    const auto loaded = transactions_->load_cache(output_cache, entry.hash);
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(output_cache, ec);
+
+    if (loaded)
+        return;
+
+    const auto first = floor_subtract(ceiling_add(top, size_t(1)),
+        size_t(settings_.cache_warmup_blocks));
+    const auto count = workers_.size() + 1u;
+
+    // Blocks are independent as spent outputs are not cached.
+    parallel(count, [&](size_t offset)
+    {
+        for (auto height = first + offset; height <= top; height += count)
+        {
+            const auto result = blocks_->get(height, false);
+
+            if (!result)
+                return;
+
+            for (const auto link: result)
+                transactions_->cache(link);
+        }
+    });
+
+    LOG_DEBUG(LOG_DATABASE)
+        << "Warmed output cache from " << (top - first + 1) << " blocks.";
+}
+
+// A failed snapshot is not an error, it is simply not reloaded.
+void data_base::save_output_cache() const
+{
+    size_t top;
+    block_database::index_entry entry;
+    if (settings_.cache_capacity == 0 || !blocks_->top(top, false) ||
+        !blocks_->get(entry, top, false))
+        return;
+
+    transactions_->save_cache(output_cache, entry.hash);
+}
+
 // TODO: incorporate into reorg loops using safe cache object, adding a call
 // each to push_block/pop_block (or promote/demote).
 system::code data_base::update_filter_cache(filter_database& database,
     const system::config::checkpoint& fork_point,
-    system::block_const_ptr_list_const_ptr incoming,
-    system::block_const_ptr_list_ptr outgoing)
+    system::block_const_ptr_list_const_ptr incoming, size_t outgoing_count)
 {
     constexpr auto interval = compact_filter_checkpoint_interval;
+
+    // Checkpoints are populated in the background following open. This must
+    // not be called within a write, as the loader reads only between writes.
+    stop_filter_loader();
+
+    // A failed load is retried here, so that its error is returned to the
+    // writer and a later reorganization may succeed.
+    if (!filter_ready_)
+    {
+        const auto ec = populate_filter_cache(database);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_DATABASE)
+                << "Failed to populate neutrino filter checkpoints: "
+                << ec.message();
+            return ec;
+        }
+
+        filter_ready_ = true;
+    }
+
     auto checkpoints = database.checkpoints();
     auto changed = false;
 
-    if (!outgoing->empty())
+    if (outgoing_count != 0)
     {
         const auto previous_height = ceiling_add(fork_point.height(),
-            outgoing->size());
+            outgoing_count);
         const auto previous_count = previous_height / interval;
         const auto fork_height_count = fork_point.height() / interval;
 
@@ -929,13 +1871,13 @@ system::code data_base::update_filter_cache(filter_database& database,
             for (auto index = last_height; index <= height;
                 index = ceiling_add(index, interval))
             {
-                const auto block_result = blocks().get(index, false);
+                block_database::index_entry entry;
 
-                if (!block_result)
+                if (!blocks().get(entry, index, false))
                     return error::operation_failed;
 
                 const auto filter_result = database.get(
-                    block_result.neutrino_filter());
+                    entry.neutrino_filter);
 
                 if (!filter_result)
                     return error::operation_failed;
@@ -951,6 +1893,73 @@ system::code data_base::update_filter_cache(filter_database& database,
     return error::success;
 }
 
+// Pruning.
+// ----------------------------------------------------------------------------
+// private
+
+// Prune fully spent txs of the block at prune depth below height, and those
+// of its spent prevouts. A tx is pruned in the block of its last spend, or in
+// its own block if it has no spendable outputs.
+bool data_base::prune(size_t height)
+{
+    const auto depth = settings_.prune_depth;
+
+    // The genesis block is never pruned.
+    if (depth == 0 || height <= depth)
+        return true;
+
+    const auto prune_height = height - depth;
+    const auto block = blocks_->get(prune_height, false);
+
+    if (!block)
+        return false;
+
+    if (block.pruned())
+        return true;
+
+    // Read all inpoints before pruning, as a tx may be spent in its block.
+    std::vector<file_offset> links;
+
+    for (const auto link: block)
+    {
+        for (const auto inpoint: transactions_->get(link))
+        {
+            if (inpoint.is_null())
+                continue;
+
+            const auto prevout = transactions_->get(inpoint.hash());
+
+            if (prevout)
+                links.push_back(prevout.link());
+        }
+
+        links.push_back(link);
+    }
+
+    for (const auto link: links)
+        if (!transactions_->prune(link, prune_height))
+            return false;
+
+    return blocks_->prune(block.link());
+}
+
+// Pruned storage is reclaimed only once no write remains journaled, as a
+// rollback would otherwise restore links into reclaimed storage. Extents
+// pruned within an overlapped (unlocked) write are retained until then.
+// Called under the exclusive write lock, which protects pruned extents.
+void data_base::reclaim()
+{
+    if (settings_.prune_depth != 0 && write_journal().is_clear())
+        transactions_->reclaim();
+}
+
+// Blocks above the prune horizon are not pruned (so may be deconfirmed).
+bool data_base::is_pruned_fork(size_t fork_height, size_t top) const
+{
+    const auto depth = settings_.prune_depth;
+    return depth != 0 && top > depth && fork_height <= top - depth;
+}
+
 // Utilities.
 // ----------------------------------------------------------------------------
 // protected
@@ -962,11 +1971,7 @@ transaction::list data_base::to_transactions(const block_result& result) const
     txs.reserve(result.transaction_count());
 
     for (const auto link: result)
-    {
-        const auto tx = transactions_->get(link);
-        BITCOIN_ASSERT(tx);
-        txs.push_back(tx.transaction());
-    }
+        txs.push_back(transactions_->get_transaction(link));
 
     return txs;
 }
@@ -18,8 +18,10 @@
  */
 #include <bitcoin/database/databases/block_database.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
@@ -123,6 +125,9 @@ bool block_database::create()
         !tx_index_file_.open())
         return false;
 
+    candidate_mirror_.clear();
+    confirmed_mirror_.clear();
+
     // No need to call open after create.
     return
         hash_table_.create() &&
@@ -142,7 +147,10 @@ bool block_database::open()
         hash_table_.start() &&
         candidate_index_.start() &&
         confirmed_index_.start() &&
-        tx_index_.start();
+        tx_index_.start() &&
+
+        load_mirror(candidate_mirror_, candidate_index_) &&
+        load_mirror(confirmed_mirror_, confirmed_index_);
 }
 
 void block_database::commit()
@@ -171,6 +179,14 @@ bool block_database::close()
         tx_index_file_.close();
 }
 
+void block_database::set_journal(journal& log)
+{
+    hash_table_file_.set_journal(log);
+    candidate_index_file_.set_journal(log);
+    confirmed_index_file_.set_journal(log);
+    tx_index_file_.set_journal(log);
+}
+
 // Queries.
 // ----------------------------------------------------------------------------
 
@@ -183,17 +199,45 @@ bool block_database::top(size_t& out_height, bool candidate) const
 block_result block_database::get(size_t height, bool candidate) const
 {
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
+    auto link = record_map::not_found;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    mirror_mutex_.lock_shared();
+    const auto& entries = mirror(manager);
+    if (height < entries.size())
+        link = entries[height].link;
+    mirror_mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
 
     return
     {
         // A not_found link value produces a terminator element.
-        hash_table_.get(read_link(height, manager)),
+        hash_table_.get(link),
         metadata_mutex_,
         tx_index_,
         support_neutrino_filter_
     };
 }
 
+bool block_database::get(index_entry& out_entry, size_t height,
+    bool candidate) const
+{
+    auto& manager = candidate ? candidate_index_ : confirmed_index_;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mirror_mutex_);
+    const auto& entries = mirror(manager);
+
+    if (height >= entries.size())
+        return false;
+
+    out_entry = entries[height];
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // Returns any state, including invalid and empty.
 block_result block_database::get(const hash_digest& hash) const
 {
@@ -206,6 +250,11 @@ block_result block_database::get(const hash_digest& hash) const
     };
 }
 
+std::vector<bool> block_database::contains(const hash_list& hashes) const
+{
+    return hash_table_.contains(hashes);
+}
+
 void block_database::get_header_metadata(const chain::header& header) const
 {
     get(header.hash()).set_metadata(header);
@@ -215,8 +264,9 @@ void block_database::get_header_metadata(const chain::header& header) const
 // ----------------------------------------------------------------------------
 
 // private
-void block_database::store(const chain::header& header, size_t height,
-    uint32_t median_time_past, uint32_t checksum, link_type tx_start,
+block_database::link_type block_database::store(const chain::header& header,
+    size_t height, uint32_t median_time_past, uint32_t checksum,
+    link_type tx_start,
     size_t tx_count, uint8_t state)
 {
     BITCOIN_ASSERT(height <= max_uint32);
@@ -236,11 +286,12 @@ void block_database::store(const chain::header& header, size_t height,
     };
 
     auto next = hash_table_.allocator();
-    next.create(header.hash(), writer);
+    const auto link = next.create(header.hash(), writer);
     hash_table_.link(next);
+    return link;
 }
 
-void block_database::store(const chain::header& header, size_t height,
+array_index block_database::store(const chain::header& header, size_t height,
     uint32_t median_time_past)
 {
     static constexpr auto tx_start = 0u;
@@ -248,10 +299,45 @@ void block_database::store(const chain::header& header, size_t height,
     static constexpr auto no_checksum = 0u;
 
     // New headers are only accepted in the candidate state.
-    store(header, height, median_time_past, no_checksum, tx_start, tx_count,
+    return store(header, height, median_time_past, no_checksum, tx_start, tx_count,
         block_state::candidate);
 }
 
+bool block_database::store(const header_const_ptr_list& headers,
+    size_t first_height)
+{
+    const auto missing = std::count_if(headers.begin(), headers.end(),
+        [](const header_const_ptr& header)
+        {
+            return !header->metadata.exists;
+        });
+
+    if (!hash_table_.reserve(missing) ||
+        !candidate_index_.reserve(headers.size()))
+        return false;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    mirror_mutex_.lock();
+    candidate_mirror_.reserve(candidate_mirror_.size() + headers.size());
+    mirror_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    auto height = first_height;
+
+    for (const auto& header: headers)
+    {
+        const auto link = header->metadata.exists ?
+            hash_table_.find(header->hash()).link() :
+            store(*header, height, header->metadata.median_time_past);
+
+        if (!promote(link, height++, true))
+            return false;
+    }
+
+    return true;
+}
+
 block_database::link_type block_database::associate(
     const transaction::list& transactions)
 {
@@ -275,7 +361,14 @@ block_database::link_type block_database::associate(
 // Populate transaction references, state is unchanged.
 bool block_database::update_transactions(const chain::block& block)
 {
-    auto element = hash_table_.find(block.hash());
+    return update_transactions(hash_table_.find(block.hash()).link(), block);
+}
+
+// Populate transaction references, state is unchanged.
+bool block_database::update_transactions(array_index link,
+    const chain::block& block)
+{
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -299,7 +392,8 @@ bool block_database::update_transactions(const chain::block& block)
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(updater);
+    element.write(updater, transactions_offset,
+        tx_start_size + tx_count_size);
     return true;
 }
 
@@ -308,8 +402,9 @@ static uint8_t update_validation_state(uint8_t original, bool positive)
     // May only validate or invalidate an unvalidated block.
     BITCOIN_ASSERT(!is_failed(original) && !is_valid(original));
 
-    // Preserve the confirmation state.
-    const auto confirmation_state = original & block_state::confirmations;
+    // Preserve the confirmation and pruning state.
+    const auto confirmation_state = original &
+        (block_state::confirmations | block_state::pruned);
     const auto validation_state = positive ? block_state::valid :
         block_state::failed;
 
@@ -320,16 +415,30 @@ static uint8_t update_validation_state(uint8_t original, bool positive)
 // Populate neutrino filter link.
 bool block_database::update_neutrino_filter(const hash_digest& hash,
     file_offset link)
+{
+    return update_neutrino_filter(hash_table_.find(hash).link(), link);
+}
+
+// Populate neutrino filter link.
+bool block_database::update_neutrino_filter(array_index block,
+    file_offset link)
 {
     if (!support_neutrino_filter_)
         return false;
 
     BITCOIN_ASSERT(link <= max_uint32);
-    auto element = hash_table_.find(hash);
+    auto element = hash_table_.get(block);
 
     if (!element)
         return false;
 
+    uint32_t height;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(height_offset);
+        height = deserial.read_4_bytes_little_endian();
+    };
+
     const auto updater = [&](byte_serializer& serial)
     {
         serial.skip(neutrino_filter_offset);
@@ -341,22 +450,32 @@ bool block_database::update_neutrino_filter(const hash_digest& hash,
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(updater);
+    element.read(reader);
+    element.write(updater, neutrino_filter_offset, neutrino_filter_size);
+    update_mirror_filter(element.link(), height, link);
     return true;
 }
 
 // Promote unvalidated block to valid|invalid based on error value.
 bool block_database::validate(const hash_digest& hash, const code& error)
 {
-    auto element = hash_table_.find(hash);
+    return validate(hash_table_.find(hash).link(), error);
+}
+
+// Promote unvalidated block to valid|invalid based on error value.
+bool block_database::validate(array_index link, const code& error)
+{
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
 
     uint8_t state;
+    uint32_t height;
     const auto reader = [&](byte_deserializer& deserial)
     {
-        deserial.skip(state_offset);
+        deserial.skip(height_offset);
+        height = deserial.read_4_bytes_little_endian();
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -365,10 +484,11 @@ bool block_database::validate(const hash_digest& hash, const code& error)
         ///////////////////////////////////////////////////////////////////////
     };
 
+    uint8_t updated;
     const auto updater = [&](byte_serializer& serial)
     {
         serial.skip(state_offset);
-        const auto updated = update_validation_state(state, !error);
+        updated = update_validation_state(state, !error);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -382,7 +502,8 @@ bool block_database::validate(const hash_digest& hash, const code& error)
     };
 
     element.read(reader);
-    element.write(updater);
+    element.write(updater, state_offset, state_size + checksum_size);
+    update_mirror(element.link(), height, updated);
     return true;
 }
 
@@ -402,7 +523,9 @@ static uint8_t update_confirmation_state(uint8_t original, bool positive,
     BITCOIN_ASSERT(positive || !candidate || is_candidate(original));
 
     // Preserve the validation state (header-indexed blocks can be pent).
-    const auto validation_state = original & block_state::validations;
+    // Preserve the pruning state (pruned txs are not restored).
+    const auto validation_state = original &
+        (block_state::validations | block_state::pruned);
     const auto positive_state = candidate ? block_state::candidate :
         block_state::confirmed;
 
@@ -418,9 +541,11 @@ void block_database::promote(const_element& element, bool positive,
     bool candidate)
 {
     uint8_t original;
+    uint32_t height;
     const auto reader = [&](byte_deserializer& deserial)
     {
-        deserial.skip(state_offset);
+        deserial.skip(height_offset);
+        height = deserial.read_4_bytes_little_endian();
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -429,10 +554,11 @@ void block_database::promote(const_element& element, bool positive,
         ///////////////////////////////////////////////////////////////////////
     };
 
+    uint8_t updated;
     const auto updater = [&](byte_serializer& serial)
     {
         serial.skip(state_offset);
-        auto updated = update_confirmation_state(original, positive, candidate);
+        updated = update_confirmation_state(original, positive, candidate);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -442,11 +568,17 @@ void block_database::promote(const_element& element, bool positive,
     };
 
     element.read(reader);
-    element.write(updater);
+    element.write(updater, state_offset, state_size);
+    update_mirror(element.link(), height, updated);
 }
 
 bool block_database::promote(const hash_digest& hash, size_t height,
     bool candidate)
+{
+    return promote(hash_table_.find(hash).link(), height, candidate);
+}
+
+bool block_database::promote(array_index link, size_t height, bool candidate)
 {
     BITCOIN_ASSERT(height != max_uint32);
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
@@ -455,7 +587,7 @@ bool block_database::promote(const hash_digest& hash, size_t height,
     if (height != manager.count())
         return false;
 
-    auto element = hash_table_.find(hash);
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -467,6 +599,11 @@ bool block_database::promote(const hash_digest& hash, size_t height,
 
 bool block_database::demote(const hash_digest& hash, size_t height,
     bool candidate)
+{
+    return demote(hash_table_.find(hash).link(), height, candidate);
+}
+
+bool block_database::demote(array_index link, size_t height, bool candidate)
 {
     BITCOIN_ASSERT(height != max_uint32);
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
@@ -475,7 +612,7 @@ bool block_database::demote(const hash_digest& hash, size_t height,
     if (height + 1u != manager.count())
         return false;
 
-    auto element = hash_table_.find(hash);
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -485,9 +622,159 @@ bool block_database::demote(const hash_digest& hash, size_t height,
     return true;
 }
 
+// Prune.
+// ----------------------------------------------------------------------------
+
+bool block_database::prune(array_index link)
+{
+    auto element = hash_table_.get(link);
+
+    if (!element)
+        return false;
+
+    uint8_t state;
+    uint32_t height;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(height_offset);
+        height = deserial.read_4_bytes_little_endian();
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        state = deserial.read_byte();
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.read(reader);
+
+    // May only prune a confirmed block.
+    if (!is_confirmed(state))
+        return false;
+
+    const uint8_t updated = state | block_state::pruned;
+    const auto updater = [&](byte_serializer& serial)
+    {
+        serial.skip(state_offset);
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(metadata_mutex_);
+        serial.write_byte(updated);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.write(updater, state_offset, state_size);
+    update_mirror(element.link(), height, updated);
+    return true;
+}
+
+// Relocation.
+// ----------------------------------------------------------------------------
+
+size_t block_database::transaction_links() const
+{
+    return tx_index_.count();
+}
+
+// Disjoint ranges may be relocated concurrently, but not while read.
+void block_database::relocate(const relocator& relocate, size_t first,
+    size_t last)
+{
+    BITCOIN_ASSERT(last <= tx_index_.count());
+
+    for (auto index = first; index < last; ++index)
+    {
+        const auto record = tx_index_.get(static_cast<link_type>(index));
+        auto deserial = make_unsafe_deserializer(record->buffer());
+        const auto link = relocate(deserial.read_8_bytes_little_endian());
+        auto serial = make_unsafe_serializer(record->buffer());
+        serial.write_8_bytes_little_endian(link);
+    }
+}
+
 // Index Utilities.
 // ----------------------------------------------------------------------------
 
+bool block_database::load_mirror(index_mirror& mirror,
+    const manager_type& manager)
+{
+    const auto count = manager.count();
+    mirror.clear();
+    mirror.reserve(count);
+
+    for (size_t height = 0; height < count; ++height)
+    {
+        const auto link = read_link(height, manager);
+
+        if (link == record_map::not_found)
+            return false;
+
+        mirror.push_back(read_entry(link));
+    }
+
+    return true;
+}
+
+block_database::index_entry block_database::read_entry(link_type link) const
+{
+    const block_result result(hash_table_.get(link), metadata_mutex_,
+        tx_index_, support_neutrino_filter_);
+
+    return
+    {
+        result.hash(),
+        link,
+        result.state(),
+        result.bits(),
+        result.timestamp(),
+        result.median_time_past(),
+        result.neutrino_filter()
+    };
+}
+
+// The state of an indexed header may change without an index push or pop.
+void block_database::update_mirror(link_type link, size_t height,
+    uint8_t state)
+{
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mirror_mutex_);
+
+    for (auto entries: { &candidate_mirror_, &confirmed_mirror_ })
+        if (height < entries->size() && (*entries)[height].link == link)
+            (*entries)[height].state = state;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The filter of an indexed header may be set after its index push.
+void block_database::update_mirror_filter(link_type link, size_t height,
+    file_offset filter)
+{
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mirror_mutex_);
+
+    for (auto entries: { &candidate_mirror_, &confirmed_mirror_ })
+        if (height < entries->size() && (*entries)[height].link == link)
+            (*entries)[height].neutrino_filter = filter;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+block_database::index_mirror& block_database::mirror(
+    const manager_type& manager)
+{
+    return &manager == &candidate_index_ ? candidate_mirror_ :
+        confirmed_mirror_;
+}
+
+const block_database::index_mirror& block_database::mirror(
+    const manager_type& manager) const
+{
+    return &manager == &candidate_index_ ? candidate_mirror_ :
+        confirmed_mirror_;
+}
+
 bool block_database::read_top(size_t& out_height,
     const manager_type& manager) const
 {
@@ -522,6 +809,12 @@ void block_database::pop_link(link_type DEBUG_ONLY(link), size_t height,
     BITCOIN_ASSERT(link == read_link(height, manager));
 
     manager.set_count(static_cast<uint32_t>(height));
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mirror_mutex_);
+    mirror(manager).pop_back();
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 void block_database::push_link(link_type link, size_t height,
@@ -532,8 +825,21 @@ void block_database::push_link(link_type link, size_t height,
 
     manager.allocate(1);
     const auto record = manager.get(static_cast<uint32_t>(height));
-    auto serial = make_unsafe_serializer(record->buffer());
-    serial.write_4_bytes_little_endian(link);
+
+    // A popped index record is overwritten in place, before its commit.
+    if (manager.preserve(record->buffer(), sizeof(uint32_t)))
+    {
+        auto serial = make_unsafe_serializer(record->buffer());
+        serial.write_4_bytes_little_endian(link);
+    }
+
+    const auto entry = read_entry(link);
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mirror_mutex_);
+    mirror(manager).push_back(entry);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 } // namespace database
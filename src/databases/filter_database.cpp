@@ -93,6 +93,11 @@ bool filter_database::close()
     return hash_table_file_.close();
 }
 
+void filter_database::set_journal(journal& log)
+{
+    hash_table_file_.set_journal(log);
+}
+
 // Queries.
 // ----------------------------------------------------------------------------
 
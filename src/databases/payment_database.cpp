@@ -112,6 +112,12 @@ bool payment_database::close()
         payment_index_file_.close();
 }
 
+void payment_database::set_journal(journal& log)
+{
+    hash_table_file_.set_journal(log);
+    payment_index_file_.set_journal(log);
+}
+
 // Queries.
 // ----------------------------------------------------------------------------
 
@@ -186,5 +192,48 @@ void payment_database::catalog(const transaction& tx)
     }
 }
 
+// Relocation.
+// ----------------------------------------------------------------------------
+
+size_t payment_database::payment_rows() const
+{
+    return payment_index_.count();
+}
+
+// Disjoint ranges may be relocated concurrently, but not while read.
+void payment_database::relocate(const relocator& relocate, size_t first,
+    size_t last)
+{
+    BITCOIN_ASSERT(last <= payment_index_.count());
+
+    // Rows are addressed directly, so list traversal is not guarded.
+    shared_mutex mutex;
+
+    for (auto row = first; row < last; ++row)
+    {
+        const record_multimap::value_type element(payment_index_,
+            static_cast<link_type>(row), mutex);
+
+        payment_record record;
+        element.read([&](byte_deserializer& deserial)
+        {
+            record.from_data(deserial, false);
+        });
+
+        const payment_record relocated
+        {
+            relocate(record.link()),
+            record.index(),
+            record.data(),
+            record.is_output()
+        };
+
+        element.write([&](byte_serializer& serial)
+        {
+            relocated.to_data(serial, false);
+        }, 0, value_size);
+    }
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -18,10 +18,14 @@
  */
 #include <bitcoin/database/databases/transaction_database.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <numeric>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/compression.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
@@ -39,12 +43,13 @@ using namespace bc::system::machine;
 // [ position:2          - atomic1  ] (unconfirmed/deconfirmed sentinel, could store state)
 // [ candidate:1         - atomic1  ] (candidate(1))
 // [ median_time_past:4  - atomic1  ] (zero if unconfirmed)
+// [ witness:8           - const    ] (not_allocated if not segregated)
 // [ output_count:varint - const    ] (tx starts here)
 // [
 //   [ candidate_spent:1 - atomic2 ]
 //   [ spender_height:4  - atomic2 ]  (could store candidate_spent in high bit)
 //   [ value:8           - const   ]
-//   [ script:varint     - const   ]
+//   [ script:compressed - const   ]  (template tag and payload, or raw)
 // ]...
 // [ input_count:varint   - const   ]
 // [
@@ -56,6 +61,12 @@ using namespace bc::system::machine;
 // [ locktime:varint      - const    ]
 // [ version:varint       - const    ]
 
+// Witness format (v4):
+// ----------------------------------------------------------------------------
+// [
+//   [ witness:varint     - const  ] (one prefixed witness for each input)
+// ]...
+
 // Record format (v3.3):
 // ----------------------------------------------------------------------------
 // [ height/forks:4         - atomic1 ]
@@ -72,6 +83,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto candidate_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(file_offset);
 
 static constexpr auto candidate_spent_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -80,17 +92,111 @@ static constexpr auto value_size = sizeof(uint64_t);
 static constexpr auto spend_size = candidate_spent_size + height_size +
     value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    candidate_size + median_time_past_size;
+    candidate_size + median_time_past_size + witness_size;
+
+static constexpr auto sequence_size = sizeof(uint32_t);
 
 static constexpr auto no_time = 0u;
 
+// Skip from the output count to the indexed output, returning its offset.
+static size_t output_offset(byte_deserializer& deserial, size_t outputs,
+    uint32_t index)
+{
+    auto offset = metadata_size + message::variable_uint_size(outputs);
+
+    for (auto output = 0u; output < index && output < outputs; ++output)
+    {
+        deserial.skip(spend_size);
+        offset += spend_size + skip_compressed(deserial);
+    }
+
+    return offset;
+}
+
+// The size of the tx as stored, excluding metadata and witnesses.
+static size_t record_size(const transaction& tx)
+{
+    const auto& outputs = tx.outputs();
+    const auto& inputs = tx.inputs();
+
+    const auto out = [](size_t total, const chain::output& output)
+    {
+        return total + spend_size + compressed_size(output.script());
+    };
+
+    const auto in = [](size_t total, const chain::input& input)
+    {
+        return total + input.serialized_size(false, false);
+    };
+
+    return
+        message::variable_uint_size(outputs.size()) +
+        std::accumulate(outputs.begin(), outputs.end(), size_t(0), out) +
+        message::variable_uint_size(inputs.size()) +
+        std::accumulate(inputs.begin(), inputs.end(), size_t(0), in) +
+        message::variable_uint_size(tx.locktime()) +
+        message::variable_uint_size(tx.version());
+}
+
+// The size of the witnesses as stored, zero if not segregated.
+static size_t witness_record_size(const transaction& tx)
+{
+    if (!tx.is_segregated())
+        return 0;
+
+    const auto& inputs = tx.inputs();
+    const auto sizer = [](size_t total, const chain::input& input)
+    {
+        return total + input.witness().serialized_size(true);
+    };
+
+    // Witnesses are variable-sized.
+    return std::accumulate(inputs.begin(), inputs.end(), size_t(0), sizer);
+}
+
+// Write the tx as stored, excluding metadata and witnesses.
+static void write_record(byte_serializer& serial, const transaction& tx)
+{
+    serial.write_size_little_endian(tx.outputs().size());
+
+    for (const auto& output: tx.outputs())
+    {
+        const auto spender_height = output.metadata.confirmed_spent_height;
+        serial.write_byte(output.metadata.candidate_spent ?
+            transaction_result::candidate_true :
+            transaction_result::candidate_false);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(spender_height));
+        serial.write_8_bytes_little_endian(output.value());
+        compress(serial, output.script());
+    }
+
+    serial.write_size_little_endian(tx.inputs().size());
+
+    for (const auto& input: tx.inputs())
+        input.to_data(serial, false, false);
+
+    serial.write_variable_little_endian(tx.locktime());
+    serial.write_variable_little_endian(tx.version());
+}
+
 // Transactions uses a hash table index, O(1).
+// Witnesses are stored in a separate slab file, linked from the tx.
 transaction_database::transaction_database(const path& map_filename,
-    size_t table_minimum, uint32_t buckets, size_t expansion,
-    size_t cache_capacity)
+    const path& witness_filename, const path& utxo_filename,
+    size_t table_minimum, size_t witness_minimum, size_t utxo_minimum,
+    uint32_t buckets, uint32_t utxo_buckets, size_t expansion,
+    size_t cache_capacity, size_t transaction_cache_capacity)
   : hash_table_file_(map_filename, table_minimum, expansion),
     hash_table_(hash_table_file_, buckets),
-    cache_(cache_capacity)
+
+    // Slab storage.
+    witness_file_(witness_filename, witness_minimum, expansion),
+    witness_manager_(witness_file_, 0),
+    utxo_(utxo_filename, utxo_minimum, utxo_buckets, expansion),
+
+    cache_(cache_capacity),
+    transaction_cache_(transaction_cache_capacity)
 {
     // TODO: C4267: 'argument': conversion from 'size_t' to 'Index', possible loss of data.
 }
@@ -105,34 +211,103 @@ transaction_database::~transaction_database()
 
 bool transaction_database::create()
 {
-    if (!hash_table_file_.open())
+    if (!hash_table_file_.open() ||
+        !witness_file_.open())
         return false;
 
     // No need to call open after create.
     return
-        hash_table_.create();
+        hash_table_.create() &&
+        witness_manager_.create() &&
+        utxo_.create();
 }
 
 bool transaction_database::open()
 {
     return
         hash_table_file_.open() &&
-        hash_table_.start();
+        witness_file_.open() &&
+        hash_table_.start() &&
+        witness_manager_.start() &&
+        utxo_.open();
 }
 
 void transaction_database::commit()
 {
+    // Witnesses are committed first as they are referenced by txs.
+    witness_manager_.commit();
     hash_table_.commit();
+    utxo_.commit();
 }
 
 bool transaction_database::flush() const
 {
-    return hash_table_file_.flush();
+    return
+        hash_table_file_.flush() &&
+        witness_file_.flush() &&
+        utxo_.flush();
 }
 
 bool transaction_database::close()
 {
-    return hash_table_file_.close();
+    transaction_cache_.clear();
+
+    return
+        hash_table_file_.close() &&
+        witness_file_.close() &&
+        utxo_.close();
+}
+
+void transaction_database::set_journal(journal& log)
+{
+    hash_table_file_.set_journal(log);
+    witness_file_.set_journal(log);
+    utxo_.set_journal(log);
+}
+
+// Output cache warm start.
+// ----------------------------------------------------------------------------
+
+bool transaction_database::load_cache(const path& filename,
+    const hash_digest& top)
+{
+    return cache_.load(filename, top);
+}
+
+bool transaction_database::save_cache(const path& filename,
+    const hash_digest& top) const
+{
+    return cache_.save(filename, top);
+}
+
+// Spent outputs are uncached, so confirmed txs may be cached in any order.
+bool transaction_database::cache(file_offset link)
+{
+    const auto result = get(link);
+
+    if (!result || result.position() == transaction_result::unconfirmed ||
+        result.position() == transaction_result::deconfirmed)
+        return false;
+
+    // A pruned tx is fully spent, so there are no outputs to cache.
+    if (result.pruned())
+        return true;
+
+    const auto tx = result.transaction(false);
+    const auto hash = result.hash();
+    cache_.add(tx, result.height(), result.median_time_past(), true);
+
+    uint32_t index = 0;
+    for (const auto& output: tx.outputs())
+    {
+        if (output.metadata.confirmed_spent_height !=
+            output::validation::not_spent)
+            cache_.remove(output_point{ hash, index });
+
+        ++index;
+    }
+
+    return true;
 }
 
 // Queries.
@@ -141,12 +316,44 @@ bool transaction_database::close()
 transaction_result transaction_database::get(file_offset link) const
 {
     // This is not guarded for an invalid offset.
-    return { hash_table_.get(link), metadata_mutex_ };
+    return { hash_table_.get(link), witness_manager_, metadata_mutex_ };
 }
 
 transaction_result transaction_database::get(const hash_digest& hash) const
 {
-    return { hash_table_.find(hash), metadata_mutex_ };
+    return { hash_table_.find(hash), witness_manager_, metadata_mutex_ };
+}
+
+std::vector<bool> transaction_database::contains(
+    const hash_list& hashes) const
+{
+    return hash_table_.contains(hashes);
+}
+
+transaction transaction_database::get_transaction(file_offset link,
+    bool witness) const
+{
+    transaction tx;
+
+    if (transaction_cache_.populate(tx, link, witness))
+        return tx;
+
+    // A metadata change after this read invalidates the decoded tx.
+    const auto epoch = transaction_cache_.epoch(link);
+
+    // This is not guarded for an invalid offset.
+    tx = get(link).transaction(witness);
+
+    // Cache only the witness form, which also serves non-segregated reads.
+    if (witness)
+        transaction_cache_.add(link, tx, epoch);
+
+    return tx;
+}
+
+float transaction_database::transaction_cache_hit_rate() const
+{
+    return transaction_cache_.hit_rate();
 }
 
 void transaction_database::get_block_metadata(const chain::transaction& tx,
@@ -224,11 +431,6 @@ void transaction_database::get_pool_metadata(const chain::transaction& tx,
 bool transaction_database::get_output(const output_point& point,
     size_t fork_height) const
 {
-    static const auto not_spent = output::validation::not_spent;
-    static const auto unconfirmed = transaction_result::unconfirmed;
-    static const auto deconfirmed = transaction_result::deconfirmed;
-    auto& prevout = point.metadata;
-
     // If the input is a coinbase there is no prevout to populate.
     if (point.is_null())
         return false;
@@ -236,7 +438,45 @@ bool transaction_database::get_output(const output_point& point,
     if (cache_.populate(point, fork_height))
         return true;
 
-    const auto result = get(point.hash());
+    // Confirmed unspent outputs are resolved with a single lookup.
+    if (utxo_.populate(point, fork_height))
+        return true;
+
+    return populate_output(get(point.hash()), point, fork_height);
+}
+
+void transaction_database::get_outputs(const point_group& points,
+    size_t fork_height) const
+{
+    point_group pending;
+    pending.reserve(points.size());
+
+    for (const auto point: points)
+        if (!point->is_null() && !cache_.populate(*point, fork_height) &&
+            !utxo_.populate(*point, fork_height))
+            pending.push_back(point);
+
+    if (pending.empty())
+        return;
+
+    // All points of a group share the tx, so it is found only once.
+    const auto result = get(pending.front()->hash());
+
+    for (const auto point: pending)
+    {
+        BITCOIN_ASSERT(point->hash() == pending.front()->hash());
+        populate_output(result, *point, fork_height);
+    }
+}
+
+// private
+bool transaction_database::populate_output(const transaction_result& result,
+    const output_point& point, size_t fork_height)
+{
+    static const auto not_spent = output::validation::not_spent;
+    static const auto unconfirmed = transaction_result::unconfirmed;
+    static const auto deconfirmed = transaction_result::deconfirmed;
+    auto& prevout = point.metadata;
 
     if (!result)
         return false;
@@ -325,17 +565,21 @@ bool transaction_database::storize(const chain::transaction& tx, size_t height,
     if (tx.metadata.existed)
         return true;
 
+    // Witnesses are stored apart so that non-witness reads can skip them.
+    const auto witness = store_witness(tx);
+
     const auto writer = [&](byte_serializer& serial)
     {
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
         serial.write_2_bytes_little_endian(static_cast<uint16_t>(position));
         serial.write_byte(transaction_result::candidate_false);
         serial.write_4_bytes_little_endian(median_time_past);
-        tx.to_data(serial, false, true);
+        serial.write_8_bytes_little_endian(witness);
+        write_record(serial, tx);
     };
 
     // Transactions are variable-sized.
-    const auto size = metadata_size + tx.serialized_size(false, true);
+    const auto size = metadata_size + record_size(tx);
 
     // Write the new transaction.
     auto next = hash_table_.allocator();
@@ -344,6 +588,51 @@ bool transaction_database::storize(const chain::transaction& tx, size_t height,
     return true;
 }
 
+// private
+file_offset transaction_database::store_witness(const chain::transaction& tx)
+{
+    if (!tx.is_segregated())
+        return manager_type::not_allocated;
+
+    const auto link = witness_manager_.allocate(witness_record_size(tx));
+    const auto memory = witness_manager_.get(link);
+    auto serial = make_unsafe_serializer(memory->buffer());
+
+    // Write one prefixed witness for each input, including empty witnesses.
+    for (const auto& input: tx.inputs())
+        input.witness().to_data(serial, true);
+
+    return link;
+}
+
+// private
+// Witnesses are variable-sized, so are walked in place.
+size_t transaction_database::stored_witness_size(file_offset witness,
+    size_t inputs) const
+{
+    if (witness == manager_type::not_allocated)
+        return 0;
+
+    const auto memory = witness_manager_.get(witness);
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+    size_t size = 0;
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        const auto count = deserial.read_size_little_endian();
+        size += message::variable_uint_size(count);
+
+        for (auto element = 0u; element < count; ++element)
+        {
+            const auto element_size = deserial.read_size_little_endian();
+            deserial.skip(element_size);
+            size += message::variable_uint_size(element_size) + element_size;
+        }
+    }
+
+    return size;
+}
+
 // Candidate/Uncandidate.
 // ----------------------------------------------------------------------------
 
@@ -382,6 +671,7 @@ bool transaction_database::candidate_spend(const chain::output_point& point,
         return false;
 
     size_t outputs;
+    size_t offset;
     const auto reader = [&](byte_deserializer& deserial)
     {
         // Critical Section
@@ -390,6 +680,8 @@ bool transaction_database::candidate_spend(const chain::output_point& point,
         deserial.skip(metadata_size);
         outputs = deserial.read_size_little_endian();
         ///////////////////////////////////////////////////////////////////////
+
+        offset = output_offset(deserial, outputs, point.index());
     };
 
     element.read(reader);
@@ -400,15 +692,7 @@ bool transaction_database::candidate_spend(const chain::output_point& point,
 
     const auto writer = [&](byte_serializer& serial)
     {
-        serial.skip(metadata_size);
-        serial.read_size_little_endian();
-
-        // Skip outputs until the target output.
-        for (auto output = 0u; output < point.index(); ++output)
-        {
-            serial.skip(spend_size);
-            serial.skip(serial.read_size_little_endian());
-        }
+        serial.skip(offset);
 
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
@@ -418,7 +702,13 @@ bool transaction_database::candidate_spend(const chain::output_point& point,
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(writer);
+    element.write(writer, offset, candidate_spent_size);
+
+    // Any cached decoded tx is now stale.
+    transaction_cache_.remove(element.link());
+
+    // Mirror the state if the output is in the confirmed utxo set.
+    utxo_.candidate(point, positive);
     return true;
 }
 
@@ -437,7 +727,10 @@ bool transaction_database::candidize(link_type link, bool positive)
     };
 
     const auto element = hash_table_.get(link);
-    element.write(writer);
+    element.write(writer, height_size + position_size, candidate_size);
+
+    // Any cached decoded tx is now stale.
+    transaction_cache_.remove(element.link());
     return true;
 }
 
@@ -485,19 +778,234 @@ bool transaction_database::confirm(const block& block, size_t height,
     return true;
 }
 
-// Should only be called for a confirmed block
+// Should only be called for a tx of a confirmed block.
+bool transaction_database::unconfirm(file_offset link)
+{
+    const auto result = get(link);
+
+    if (!result)
+        return false;
+
+    // Unspend the tx's previous outputs.
+    for (const auto inpoint: result)
+        if (!confirmed_spend(inpoint, rule_fork::unverified))
+            return false;
+
+    // Demote the tx.
+    if (!confirmize(link, rule_fork::unverified, no_time,
+        transaction_result::deconfirmed))
+        return false;
+
+    // Uncache the unspent outputs of the unconfirmed transaction.
+    cache_.remove(result.hash());
+    return true;
+}
+
+// Should only be called for a confirmed block.
 bool transaction_database::unconfirm(const block& block)
 {
     for (const auto& tx: block.transactions())
-    {
-        if (!confirm(tx.metadata.link, rule_fork::unverified, no_time,
-            transaction_result::deconfirmed))
+        if (!unconfirm(tx.metadata.link))
             return false;
 
-        // Uncache the unspent outputs of the unconfirmed transaction.
-        cache_.remove(tx.hash());
+    return true;
+}
+
+// Prune/Reclaim.
+// ----------------------------------------------------------------------------
+
+// The header, key and metadata of a pruned tx are retained, so the tx remains
+// in the hash table and reports its confirmation. The outputs, inputs and
+// witnesses are no longer readable and their pages are reclaimed later.
+bool transaction_database::prune(file_offset link, size_t height)
+{
+    static const auto not_spent = output::validation::not_spent;
+    const auto result = get(link);
+
+    if (!result)
+        return false;
+
+    // Retain unconfirmed txs, txs above height, and those already pruned.
+    const auto position = result.position();
+    if (position == transaction_result::unconfirmed ||
+        position == transaction_result::deconfirmed ||
+        result.height() > height || result.pruned())
+        return true;
+
+    auto retain = false;
+    size_t inputs = 0;
+    size_t size = 0;
+    file_offset witness;
+
+    // Spend metadata is read in place and the record sized as it is walked.
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(height_size + position_size + candidate_size +
+            median_time_past_size);
+
+        // The witness link is const until pruned.
+        witness = deserial.read_8_bytes_little_endian();
+
+        const auto outputs = deserial.read_size_little_endian();
+        size += message::variable_uint_size(outputs);
+
+        // Retain txs with any spendable output not spent at or below height.
+        for (auto output = 0u; output < outputs; ++output)
+        {
+            auto unspendable = false;
+            deserial.skip(candidate_spent_size);
+            const auto spender_height = deserial.read_4_bytes_little_endian();
+            deserial.skip(value_size);
+            size += spend_size + skip_compressed(deserial, unspendable);
+
+            if (!unspendable &&
+                (spender_height == not_spent || spender_height > height))
+            {
+                retain = true;
+                return;
+            }
+        }
+
+        inputs = deserial.read_size_little_endian();
+        size += message::variable_uint_size(inputs);
+
+        for (auto input = 0u; input < inputs; ++input)
+        {
+            deserial.skip(point::satoshi_fixed_size(false));
+            const auto script = deserial.read_size_little_endian();
+            deserial.skip(script + sequence_size);
+            size += point::satoshi_fixed_size(false) +
+                message::variable_uint_size(script) + script + sequence_size;
+        }
+
+        size += message::variable_uint_size(
+            deserial.read_variable_little_endian());
+        size += message::variable_uint_size(
+            deserial.read_variable_little_endian());
+    };
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.skip(height_size + position_size + candidate_size +
+            median_time_past_size);
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(metadata_mutex_);
+        serial.write_8_bytes_little_endian(transaction_result::pruned_body);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    const auto element = hash_table_.get(link);
+    element.read(reader);
+
+    if (retain)
+        return true;
+
+    element.write(writer, metadata_size - witness_size, witness_size);
+
+    // Any cached decoded tx is now stale.
+    transaction_cache_.remove(element.link());
+    cache_.remove(result.hash());
+
+    pruned_.push_back(
+    {
+        element.link(),
+        size,
+        witness,
+        stored_witness_size(witness, inputs)
+    });
+
+    return true;
+}
+
+// Storage failing to reclaim remains allocated (and unread).
+bool transaction_database::reclaim()
+{
+    auto reclaimed = true;
+
+    for (const auto& extent: pruned_)
+    {
+        if (!hash_table_.get(extent.link).reclaim(metadata_size, extent.size))
+            reclaimed = false;
+
+        if (extent.witness == manager_type::not_allocated)
+            continue;
+
+        const auto memory = witness_manager_.get(extent.witness);
+        if (!witness_manager_.reclaim(memory->buffer(), extent.witness_size))
+            reclaimed = false;
+    }
+
+    pruned_.clear();
+    return reclaimed;
+}
+
+// Relocation.
+// ----------------------------------------------------------------------------
+
+// The record and witnesses are copied as stored, only the witness link moves.
+bool transaction_database::relocate(file_offset& out_link,
+    const transaction_database& source, file_offset link)
+{
+    const auto result = source.get(link);
+
+    if (!result)
+        return false;
+
+    const auto element = source.hash_table_.get(link);
+    const auto key = element.key();
+    const auto existing = hash_table_.find(key);
+
+    if (existing)
+    {
+        out_link = existing.link();
+        return true;
     }
 
+    // A pruned tx retains only its metadata, the body is not read.
+    const auto pruned = result.pruned();
+    const auto tx = pruned ? transaction{} : result.transaction(true);
+    const auto size = pruned ? 0 : record_size(tx);
+
+    data_chunk metadata;
+    data_chunk record;
+    file_offset witness;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(source.metadata_mutex_);
+        metadata = deserial.read_bytes(metadata_size - witness_size);
+        witness = deserial.read_8_bytes_little_endian();
+        ///////////////////////////////////////////////////////////////////////
+
+        record = deserial.read_bytes(size);
+    };
+
+    element.read(reader);
+
+    if (witness != manager_type::not_allocated &&
+        witness != transaction_result::pruned_body)
+    {
+        const auto bytes = witness_record_size(tx);
+        const auto copy = witness_manager_.allocate(bytes);
+        const auto from = source.witness_manager_.get(witness);
+        const auto to = witness_manager_.get(copy);
+        std::copy_n(from->buffer(), bytes, to->buffer());
+        witness = copy;
+    }
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_bytes(metadata);
+        serial.write_8_bytes_little_endian(witness);
+        serial.write_bytes(record);
+    };
+
+    auto next = hash_table_.allocator();
+    out_link = next.create(key, writer, metadata_size + size);
+    hash_table_.link(next);
     return true;
 }
 
@@ -516,6 +1024,7 @@ bool transaction_database::confirmed_spend(const output_point& point,
         return false;
 
     size_t outputs;
+    size_t offset;
     uint32_t height;
     uint16_t position;
     const auto reader = [&](byte_deserializer& deserial)
@@ -525,9 +1034,11 @@ bool transaction_database::confirmed_spend(const output_point& point,
         shared_lock lock(metadata_mutex_);
         height = deserial.read_4_bytes_little_endian();
         position = deserial.read_2_bytes_little_endian();
-        deserial.skip(candidate_size + median_time_past_size);
+        deserial.skip(candidate_size + median_time_past_size + witness_size);
         outputs = deserial.read_size_little_endian();
         ///////////////////////////////////////////////////////////////////////
+
+        offset = output_offset(deserial, outputs, point.index());
     };
 
     element.read(reader);
@@ -546,17 +1057,7 @@ bool transaction_database::confirmed_spend(const output_point& point,
 
     const auto writer = [&](byte_serializer& serial)
     {
-        serial.skip(metadata_size);
-        serial.read_size_little_endian();
-
-        // Skip outputs until the target output.
-        for (auto output = 0u; output < point.index(); ++output)
-        {
-            serial.skip(spend_size);
-            serial.skip(serial.read_size_little_endian());
-        }
-
-        serial.skip(candidate_spent_size);
+        serial.skip(offset + candidate_spent_size);
 
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
@@ -566,7 +1067,26 @@ bool transaction_database::confirmed_spend(const output_point& point,
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(writer);
+    element.write(writer, offset + candidate_spent_size, height_size);
+
+    // Any cached decoded tx is now stale.
+    transaction_cache_.remove(element.link());
+
+    // Remove the spent output from the confirmed utxo set.
+    if (spend_height != output::validation::not_spent)
+    {
+        utxo_.remove(point);
+        return true;
+    }
+
+    // Restore the unspent output unless its tx has also been deconfirmed.
+    if (position != transaction_result::deconfirmed && height != 0)
+    {
+        const auto result = get(element.link());
+        utxo_.store(point, result.output(point.index()), height,
+            result.median_time_past(), position == 0);
+    }
+
     return true;
 }
 
@@ -590,9 +1110,66 @@ bool transaction_database::confirmize(link_type link, size_t height,
     };
 
     const auto element = hash_table_.get(link);
-    element.write(writer);
+    element.write(writer, 0, height_size + position_size + candidate_size +
+        median_time_past_size);
+
+    // Any cached decoded tx is now stale.
+    transaction_cache_.remove(element.link());
+
+    // Add or remove the outputs of the tx in the confirmed utxo set.
+    if (position != transaction_result::unconfirmed)
+        confirm_outputs(link, height, median_time_past, position);
+
     return true;
 }
 
+// private
+void transaction_database::confirm_outputs(link_type link, size_t height,
+    uint32_t median_time_past, size_t position)
+{
+    static const auto not_spent = output::validation::not_spent;
+    const auto deconfirm = position == transaction_result::deconfirmed;
+
+    // The genesis block coinbase output may not be spent (see get_output).
+    if (!deconfirm && height == 0)
+        return;
+
+    const auto element = hash_table_.get(link);
+    const auto hash = element.key();
+
+    // Spentness is unguarded and will be inconsistent during write.
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(metadata_size);
+        const auto outputs = deserial.read_size_little_endian();
+
+        for (uint32_t index = 0; index < outputs; ++index)
+        {
+            const output_point point{ hash, index };
+            const auto candidate_spent = deserial.read_byte() ==
+                transaction_result::candidate_true;
+            const auto spender_height = deserial.read_4_bytes_little_endian();
+            const auto value = deserial.read_8_bytes_little_endian();
+
+            if (deconfirm || spender_height != not_spent)
+            {
+                skip_compressed(deserial);
+
+                if (deconfirm)
+                    utxo_.remove(point);
+
+                continue;
+            }
+
+            chain::output output(value, decompress(deserial));
+            output.metadata.candidate_spent = candidate_spent;
+            utxo_.store(point, output, height, median_time_past,
+                position == 0);
+        }
+    };
+
+    element.read(reader);
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/utxo_database.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/compression.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// Record format (v4):
+// ----------------------------------------------------------------------------
+// [ candidate_spent:1   - atomic ]
+// [ height:4            - const  ]
+// [ median_time_past:4  - const  ]
+// [ coinbase:1          - const  ]
+// [ value:8             - const  ]
+// [ script:compressed   - const  ]
+
+static constexpr auto candidate_spent_size = sizeof(uint8_t);
+static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto coinbase_size = sizeof(uint8_t);
+static constexpr auto value_size = sizeof(uint64_t);
+
+static constexpr auto metadata_size = candidate_spent_size + height_size +
+    median_time_past_size + coinbase_size + value_size;
+
+// Unspent outputs use a hash table index, O(1).
+utxo_database::utxo_database(const path& map_filename, size_t table_minimum,
+    uint32_t buckets, size_t expansion)
+  : hash_table_file_(map_filename, table_minimum, expansion),
+    hash_table_(hash_table_file_, buckets)
+{
+    // TODO: C4267: 'argument': conversion from 'size_t' to 'Index', possible loss of data.
+}
+
+utxo_database::~utxo_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool utxo_database::create()
+{
+    if (!hash_table_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return
+        hash_table_.create();
+}
+
+bool utxo_database::open()
+{
+    return
+        hash_table_file_.open() &&
+        hash_table_.start();
+}
+
+void utxo_database::commit()
+{
+    hash_table_.commit();
+}
+
+bool utxo_database::flush() const
+{
+    return hash_table_file_.flush();
+}
+
+bool utxo_database::close()
+{
+    return hash_table_file_.close();
+}
+
+void utxo_database::set_journal(journal& log)
+{
+    hash_table_file_.set_journal(log);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+// Metadata should be defaulted by caller.
+bool utxo_database::populate(const output_point& point,
+    size_t fork_height) const
+{
+    static const auto not_spent = output::validation::not_spent;
+    const auto element = hash_table_.find(to_key(point));
+
+    if (!element)
+        return false;
+
+    bool candidate_spent;
+    uint32_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    uint64_t value;
+    chain::script script;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        metadata_mutex_.lock_shared();
+        candidate_spent = deserial.read_byte() ==
+            transaction_result::candidate_true;
+        metadata_mutex_.unlock_shared();
+        ///////////////////////////////////////////////////////////////////////
+
+        height = deserial.read_4_bytes_little_endian();
+        median_time_past = deserial.read_4_bytes_little_endian();
+        coinbase = deserial.read_byte() != 0;
+        value = deserial.read_8_bytes_little_endian();
+        script = decompress(deserial);
+    };
+
+    element.read(reader);
+
+    // The output is confirmed and unspent by any confirmed tx.
+    auto& prevout = point.metadata;
+    prevout.height = height;
+    prevout.median_time_past = median_time_past;
+    prevout.coinbase = coinbase;
+    prevout.candidate = false;
+    prevout.confirmed = height <= fork_height;
+    prevout.candidate_spent = candidate_spent;
+    prevout.confirmed_spent = false;
+    prevout.cache = chain::output(value, std::move(script));
+    prevout.cache.metadata.candidate_spent = candidate_spent;
+    prevout.cache.metadata.confirmed_spent_height = not_spent;
+    return true;
+}
+
+// Writers.
+// ----------------------------------------------------------------------------
+
+bool utxo_database::store(const output_point& point, const output& output,
+    size_t height, uint32_t median_time_past, bool coinbase)
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+    const auto key = to_key(point);
+
+    // A duplicate point (BIP30) replaces the existing output.
+    hash_table_.unlink(key);
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_byte(output.metadata.candidate_spent ?
+            transaction_result::candidate_true :
+            transaction_result::candidate_false);
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+        serial.write_4_bytes_little_endian(median_time_past);
+        serial.write_byte(coinbase ? 1 : 0);
+        serial.write_8_bytes_little_endian(output.value());
+        compress(serial, output.script());
+    };
+
+    // Outputs are variable-sized.
+    const auto size = metadata_size + compressed_size(output.script());
+
+    auto next = hash_table_.allocator();
+    next.create(key, writer, size);
+    hash_table_.link(next);
+    return true;
+}
+
+// The unlinked slab is not reclaimed.
+bool utxo_database::remove(const output_point& point)
+{
+    return hash_table_.unlink(to_key(point));
+}
+
+bool utxo_database::candidate(const output_point& point, bool positive)
+{
+    const auto element = hash_table_.find(to_key(point));
+
+    // Only confirmed unspent outputs are present.
+    if (!element)
+        return false;
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(metadata_mutex_);
+        serial.write_byte(positive ? transaction_result::candidate_true :
+            transaction_result::candidate_false);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.write(writer, 0, sizeof(uint8_t));
+    return true;
+}
+
+// private
+utxo_database::key_type utxo_database::to_key(const output_point& point)
+{
+    key_type key;
+    auto serial = make_unsafe_serializer(key.data());
+    serial.write_hash(point.hash());
+    serial.write_4_bytes_little_endian(point.index());
+    return key;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -40,6 +40,7 @@
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
+#include <bitcoin/database/memory/journal.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 
 // file_storage is able to support 32 bit, but because the database
@@ -171,6 +172,7 @@ file_storage::file_storage(const path& filename, size_t minimum,
     minimum_(minimum),
     expansion_(expansion),
     filename_(filename),
+    journal_(nullptr),
     closed_(true),
     data_(nullptr),
     capacity_(file_size(file_handle_)),
@@ -315,6 +317,57 @@ bool file_storage::closed() const
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// Journaling.
+// ----------------------------------------------------------------------------
+
+// The caller holds access to the address, which precludes remap of data_.
+bool file_storage::preserve(const uint8_t* address, size_t size)
+{
+    const auto log = journal_.load();
+
+    if (log == nullptr)
+        return true;
+
+    BITCOIN_ASSERT(address >= data_ && address + size <= data_ + capacity_);
+    return log->record(filename_, address - data_, address, size);
+}
+
+void file_storage::set_journal(journal& log)
+{
+    journal_.store(&log);
+}
+
+// Reclamation.
+// ----------------------------------------------------------------------------
+
+// The caller holds access to the address, which precludes remap of data_.
+// Reclaimed pages are not journaled, so must not be reclaimed during a write.
+bool file_storage::reclaim(const uint8_t* address, size_t size)
+{
+    BITCOIN_ASSERT(address >= data_ && address + size <= data_ + capacity_);
+
+#ifdef MADV_REMOVE
+    const auto page_size = page();
+
+    if (page_size == 0)
+        return false;
+
+    // The map is page aligned, so whole pages within the range are released.
+    const auto start = static_cast<size_t>(address - data_);
+    const auto first = ((start + page_size - 1) / page_size) * page_size;
+    const auto last = ((start + size) / page_size) * page_size;
+
+    if (last <= first)
+        return true;
+
+    // Punch a hole in the file, which is backfilled with zeros if read.
+    return madvise(data_ + first, last - first, MADV_REMOVE) != FAIL;
+#else
+    // The range remains allocated where hole punching is not supported.
+    return true;
+#endif
+}
+
 // Operations.
 // ----------------------------------------------------------------------------
 
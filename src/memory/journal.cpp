@@ -0,0 +1,317 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/journal.hpp>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <share.h>
+    #include <windows.h>
+    #include "../mman-win32/mman.h"
+#else
+    #include <unistd.h>
+#endif
+#if defined(__APPLE__) || defined(__FreeBSD__)
+    #include <sys/sysctl.h>
+    #include <sys/time.h>
+#endif
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+#define FAIL -1
+
+journal::journal(const path& filename, bool synchronize)
+  : filename_(filename),
+    synchronize_(synchronize),
+    boot_(boot_identity()),
+    writers_(0),
+    dirty_(false),
+    synchronized_(true),
+    failed_(false)
+{
+}
+
+journal::~journal()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool journal::open()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    writers_ = 0;
+    failed_ = false;
+    return reset();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool journal::close()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    stream_.reset();
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Write tracking.
+// ----------------------------------------------------------------------------
+
+void journal::begin()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    ++writers_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Overlapping writes share the log, so it is cleared only when all have
+// ended. An unbalanced end is ignored (as is an unbalanced flush unlock).
+// Following a failed entry the log is retained, as its write is incomplete.
+bool journal::end()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (writers_ > 0)
+        --writers_;
+
+    if (failed_)
+        return false;
+
+    return writers_ > 0 || !dirty_ || !stream_ || reset();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Entries are forced to disk once per write rather than once per entry.
+bool journal::flush()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (!synchronize_ || synchronized_)
+        return true;
+
+    synchronized_ = synchronize();
+    return synchronized_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool journal::is_clear() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return writers_ == 0 && !dirty_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Each entry is passed to the file system before the range is overwritten, so
+// that it survives termination of the process. If synchronizing, it is forced
+// to disk by flush, so that it survives termination of the system.
+bool journal::record(const path& file, file_offset position,
+    const uint8_t* data, size_t size)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        if (stream_)
+        {
+            ostream_writer sink(*stream_);
+            sink.write_string(file.filename().string());
+            sink.write_8_bytes_little_endian(position);
+            sink.write_4_bytes_little_endian(static_cast<uint32_t>(size));
+            sink.write_bytes(data, size);
+            stream_->flush();
+            dirty_ = true;
+            synchronized_ = false;
+        }
+
+        if (stream_ && stream_->good())
+            return true;
+
+        failed_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    LOG_FATAL(LOG_DATABASE)
+        << "The journal failed to record a write: " << filename_;
+    return false;
+}
+
+// Recovery.
+// ----------------------------------------------------------------------------
+
+// static
+bool journal::rollback(const path& filename)
+{
+    std::vector<entry> entries;
+
+    {
+        ifstream stream(filename.string(), std::ios::binary);
+
+        if (!stream.good())
+            return false;
+
+        istream_reader source(stream);
+        const auto synchronized = source.read_byte() == 1;
+        const auto boot = source.read_string();
+
+        if (!source)
+            return false;
+
+        // An unsynchronized log survives only within its system boot, as a
+        // restart may have lost entries and mapped pages.
+        if (!synchronized && (boot.empty() || boot != boot_identity()))
+            return false;
+
+        while (!source.is_exhausted())
+        {
+            entry next;
+            next.name = source.read_string();
+            next.position = source.read_8_bytes_little_endian();
+            next.data = source.read_bytes(source.read_4_bytes_little_endian());
+
+            // A truncated entry was not completed, so its range is unchanged.
+            if (!source)
+                break;
+
+            entries.push_back(std::move(next));
+        }
+    }
+
+    const auto directory = filename.parent_path();
+
+    // Restore the oldest value last, since a range may be logged repeatedly.
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        std::fstream file((directory / it->name).string(),
+            std::ios::in | std::ios::out | std::ios::binary);
+
+        file.seekp(it->position);
+        file.write(reinterpret_cast<const char*>(it->data.data()),
+            it->data.size());
+
+        if (!file.good())
+            return false;
+    }
+
+    if (!entries.empty())
+        LOG_INFO(LOG_DATABASE)
+            << "Restored " << entries.size() << " journaled ranges.";
+
+    return ofstream(filename.string(), std::ios::binary).good();
+}
+
+// static
+// The identifier changes on restart of the system, and a mismatch is safe (the
+// log is not restored), so an approximate boot time suffices where no boot
+// identifier is provided.
+std::string journal::boot_identity()
+{
+#if defined(_WIN32)
+    // Seconds since epoch at boot, coarsened to absorb the tick resolution.
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto uptime = static_cast<long long>(GetTickCount64() / 1000);
+    return std::to_string((now - uptime) / 10);
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+    int name[] = { CTL_KERN, KERN_BOOTTIME };
+    struct timeval boot;
+    auto size = sizeof(boot);
+
+    if (sysctl(name, 2, &boot, &size, nullptr, 0) == FAIL)
+        return {};
+
+    return std::to_string(boot.tv_sec) + "." + std::to_string(boot.tv_usec);
+#else
+    std::string identity;
+    ifstream stream("/proc/sys/kernel/random/boot_id");
+    std::getline(stream, identity);
+    return identity;
+#endif
+}
+
+// private
+// ----------------------------------------------------------------------------
+
+// Truncate the log file to its header, leaving it open for append.
+bool journal::reset()
+{
+    stream_.reset();
+    stream_.reset(new ofstream(filename_.string(), std::ios::binary));
+    ostream_writer sink(*stream_);
+    sink.write_byte(synchronize_ ? 1 : 0);
+    sink.write_string(boot_);
+    stream_->flush();
+    dirty_ = false;
+    synchronized_ = !synchronize_ || synchronize();
+    return stream_->good() && synchronized_;
+}
+
+// Force the log file to disk (the stream is flushed to the file system).
+bool journal::synchronize() const
+{
+#ifdef _WIN32
+    int handle;
+    if (_wsopen_s(&handle, filename_.wstring().c_str(),
+        (O_RDWR | _O_BINARY), _SH_DENYNO, (_S_IREAD | _S_IWRITE)) != 0)
+        return false;
+
+    const auto synchronized = fsync(handle) != FAIL;
+    return (_close(handle) != FAIL) && synchronized;
+#else
+    const auto handle = ::open(filename_.string().c_str(), O_RDWR);
+
+    if (handle == FAIL)
+        return false;
+
+    const auto synchronized = fsync(handle) != FAIL;
+    return (::close(handle) != FAIL) && synchronized;
+#endif
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/metrics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+const size_t metrics::operations;
+
+// Timer.
+// ----------------------------------------------------------------------------
+
+metrics::timer::timer(metrics& registry, operation operation, size_t units)
+  : registry_(registry),
+    operation_(operation),
+    units_(units),
+    start_(clock::now())
+{
+}
+
+metrics::timer::~timer()
+{
+    registry_.record(operation_, std::chrono::duration_cast<duration>(
+        clock::now() - start_), units_);
+}
+
+void metrics::timer::locked()
+{
+    const auto now = clock::now();
+    registry_.record_wait(operation_,
+        std::chrono::duration_cast<duration>(now - start_));
+    start_ = now;
+}
+
+void metrics::timer::set_units(size_t units)
+{
+    units_ = units;
+}
+
+// Histogram.
+// ----------------------------------------------------------------------------
+
+// Values below sub_buckets are exact. Above that each power of two (exponent)
+// is divided into sub_buckets, indexed by the top bits of the value.
+size_t metrics::histogram::to_bucket(uint64_t value)
+{
+    if (value < sub_buckets)
+        return static_cast<size_t>(value);
+
+    size_t exponent = 0;
+    for (auto shifted = value >> sub_bucket_bits; shifted != 0; shifted >>= 1)
+        ++exponent;
+
+    if (exponent > max_exponent)
+        return buckets - 1;
+
+    const auto top = static_cast<size_t>(value >> (exponent - 1));
+    return exponent * sub_buckets + (top - sub_buckets);
+}
+
+// The largest value recorded to the bucket.
+uint64_t metrics::histogram::to_upper(size_t bucket)
+{
+    if (bucket < sub_buckets)
+        return bucket;
+
+    const auto exponent = bucket / sub_buckets;
+    const uint64_t top = sub_buckets + bucket % sub_buckets;
+    return ((top + 1) << (exponent - 1)) - 1;
+}
+
+metrics::histogram::histogram()
+  : total_(0), maximum_(0)
+{
+    for (auto& bucket: buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void metrics::histogram::record(uint64_t value)
+{
+    buckets_[to_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+
+    auto maximum = maximum_.load(std::memory_order_relaxed);
+    while (value > maximum && !maximum_.compare_exchange_weak(maximum, value,
+        std::memory_order_relaxed));
+}
+
+// Buckets are copied first, so that the count and percentiles are consistent.
+metrics::distribution metrics::histogram::summarize() const
+{
+    std::array<uint64_t, buckets> counts;
+    uint64_t count = 0;
+
+    for (size_t bucket = 0; bucket < buckets; ++bucket)
+    {
+        counts[bucket] = buckets_[bucket].load(std::memory_order_relaxed);
+        count += counts[bucket];
+    }
+
+    const auto maximum = maximum_.load(std::memory_order_relaxed);
+
+    // The value at or below which the per mille fraction of values fall.
+    const auto percentile = [&](uint64_t per_mille)
+    {
+        const auto rank = std::max<uint64_t>((count * per_mille + 999) / 1000,
+            1);
+
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket < buckets; ++bucket)
+            if ((cumulative += counts[bucket]) >= rank)
+                return duration(bucket == buckets - 1 ? maximum :
+                    std::min(to_upper(bucket), maximum));
+
+        return duration(maximum);
+    };
+
+    if (count == 0)
+        return { 0, duration(0), duration(0), duration(0), duration(0),
+            duration(0), duration(0) };
+
+    return
+    {
+        count,
+        duration(total_.load(std::memory_order_relaxed)),
+        duration(maximum),
+        percentile(500),
+        percentile(900),
+        percentile(990),
+        percentile(999)
+    };
+}
+
+// Metrics.
+// ----------------------------------------------------------------------------
+
+metrics::metrics()
+  : start_(clock::now())
+{
+    for (auto& entry: entries_)
+        entry.units.store(0, std::memory_order_relaxed);
+}
+
+std::string metrics::to_string(operation operation)
+{
+    switch (operation)
+    {
+        case operation::push:
+            return "push";
+        case operation::update:
+            return "update";
+        case operation::invalidate:
+            return "invalidate";
+        case operation::candidate:
+            return "candidate";
+        case operation::confirm:
+            return "confirm";
+        case operation::store:
+            return "store";
+        case operation::catalog:
+            return "catalog";
+        case operation::reorganize_headers:
+            return "reorganize_headers";
+        case operation::push_headers:
+            return "push_headers";
+        case operation::pop_header:
+            return "pop_header";
+        case operation::reorganize_blocks:
+            return "reorganize_blocks";
+        case operation::push_block:
+            return "push_block";
+        case operation::pop_block:
+            return "pop_block";
+        case operation::catalog_block:
+            return "catalog_block";
+        case operation::filter:
+            return "filter";
+        case operation::read:
+            return "read";
+        case operation::prefetch:
+            return "prefetch";
+        case operation::flush:
+            return "flush";
+        default:
+            return "unknown";
+    }
+}
+
+void metrics::record(operation operation, const duration& latency,
+    size_t units)
+{
+    auto& entry = entries_[operation];
+    entry.units.fetch_add(units, std::memory_order_relaxed);
+    entry.latency.record(static_cast<uint64_t>(latency.count()));
+}
+
+void metrics::record_wait(operation operation, const duration& wait)
+{
+    entries_[operation].lock_wait.record(static_cast<uint64_t>(wait.count()));
+}
+
+metrics::report metrics::snapshot() const
+{
+    report out;
+    out.uptime = std::chrono::duration_cast<duration>(clock::now() - start_);
+    out.operations.reserve(operations);
+
+    for (size_t index = 0; index < operations; ++index)
+    {
+        const auto& entry = entries_[index];
+        out.operations.push_back(
+        {
+            to_string(static_cast<operation>(index)),
+            entry.units.load(std::memory_order_relaxed),
+            entry.latency.summarize(),
+            entry.lock_wait.summarize()
+        });
+    }
+
+    return out;
+}
+
+} // namespace database
+} // namespace libbitcoin
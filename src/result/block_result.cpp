@@ -163,6 +163,11 @@ uint8_t block_result::state() const
     return state_;
 }
 
+bool block_result::pruned() const
+{
+    return is_pruned(state_);
+}
+
 uint32_t block_result::checksum() const
 {
     return checksum_;
@@ -19,6 +19,7 @@
 #include <bitcoin/database/result/inpoint_iterator.hpp>
 
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/compression.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -30,6 +31,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(file_offset);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -37,7 +39,7 @@ static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+    state_size + median_time_past_size + witness_size;
 
 static constexpr auto sequence_size = sizeof(uint32_t);
 
@@ -57,7 +59,7 @@ inpoint_iterator::inpoint_iterator(const const_element& element)
             for (auto output = 0u; output < outputs; ++output)
             {
                 deserial.skip(spend_size);
-                deserial.skip(deserial.read_size_little_endian());
+                skip_compressed(deserial);
             }
 
             const auto inputs = deserial.read_size_little_endian();
@@ -68,14 +70,9 @@ inpoint_iterator::inpoint_iterator(const const_element& element)
                 // Read input point.
                 inpoints_[input].from_data(deserial, false);
 
-                // Skip script.
+                // Skip script (witnesses are stored apart from the tx).
                 deserial.skip(deserial.read_size_little_endian());
 
-                // Skip witnesses.
-                for (auto count = deserial.read_size_little_endian();
-                    count > 0; --count)
-                    deserial.skip(deserial.read_size_little_endian());
-
                 // Skip sequence.
                 deserial.skip(sequence_size);
             }
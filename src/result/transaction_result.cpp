@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <utility>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/compression.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 
@@ -36,6 +37,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(file_offset);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -43,21 +45,40 @@ static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+    state_size + median_time_past_size + witness_size;
+
+static constexpr auto sequence_size = sizeof(uint32_t);
+
+// Read an output as stored, including spent metadata.
+static chain::output read_output(byte_deserializer& deserial)
+{
+    const auto candidate_spent = deserial.read_byte() ==
+        transaction_result::candidate_true;
+    const auto spender_height = deserial.read_4_bytes_little_endian();
+    const auto value = deserial.read_8_bytes_little_endian();
+
+    chain::output output(value, decompress(deserial));
+    output.metadata.candidate_spent = candidate_spent;
+    output.metadata.confirmed_spent_height = spender_height;
+    return output;
+}
 
 const uint8_t transaction_result::candidate_true = 1;
 const uint8_t transaction_result::candidate_false = 0;
 const uint16_t transaction_result::unconfirmed = max_uint16;
 const uint16_t transaction_result::deconfirmed = max_uint16 - 1;
 const uint32_t transaction_result::unverified = rule_fork::unverified;
+const file_offset transaction_result::pruned_body = manager::not_allocated - 1;
 
 transaction_result::transaction_result(const const_element_type& element,
-    shared_mutex& metadata_mutex)
+    const manager& witness_manager, shared_mutex& metadata_mutex)
   : candidate_(false),
     height_(0),
     position_(unconfirmed),
     median_time_past_(0),
+    witness_(manager::not_allocated),
     element_(element),
+    witness_manager_(witness_manager),
     metadata_mutex_(metadata_mutex)
 {
     if (!element_)
@@ -74,6 +95,9 @@ transaction_result::transaction_result(const const_element_type& element,
         candidate_ = deserial.read_byte() == candidate_true;
         median_time_past_ = deserial.read_4_bytes_little_endian();
         ///////////////////////////////////////////////////////////////////////
+
+        // The witness link is const until pruned.
+        witness_ = deserial.read_8_bytes_little_endian();
     };
 
     // Metadata reads not deferred for updatable values as atomicity required.
@@ -119,6 +143,11 @@ uint32_t transaction_result::median_time_past() const
     return median_time_past_;
 }
 
+bool transaction_result::pruned() const
+{
+    return witness_ == pruned_body;
+}
+
 bool transaction_result::is_candidate_spent(size_t fork_height) const
 {
     // Cannot be spent unless candidate or confirmed by fork height.
@@ -127,6 +156,10 @@ bool transaction_result::is_candidate_spent(size_t fork_height) const
         ((position_ == unconfirmed) || (height_ > fork_height)))
         return false;
 
+    // Only fully spent txs are pruned, and only below the fork height.
+    if (pruned())
+        return true;
+
     BITCOIN_ASSERT(element_);
     auto spent = true;
 
@@ -139,10 +172,12 @@ bool transaction_result::is_candidate_spent(size_t fork_height) const
         // Search all outputs for an unspent indication.
         for (auto out = 0u; spent && out < outputs; ++out)
         {
-            // TODO: This reads full output, which is simple but not optimial.
-            const auto output = output::factory(deserial, false);
-            spent = output.metadata.candidate_spent ||
-                output.metadata.confirmed_spent_height <= fork_height;
+            const auto candidate_spent = deserial.read_byte() ==
+                candidate_true;
+            const auto spender_height = deserial.read_4_bytes_little_endian();
+            deserial.skip(value_size);
+            skip_compressed(deserial);
+            spent = candidate_spent || spender_height <= fork_height;
         }
     };
 
@@ -179,11 +214,15 @@ bool transaction_result::is_candidate_spent(size_t fork_height) const
 ////}
 
 // If index is out of range returns default/invalid output (.value not_found).
+// The output of a pruned tx is spent and not retained, so is also invalid.
 chain::output transaction_result::output(uint32_t index) const
 {
     BITCOIN_ASSERT(element_);
     chain::output output;
 
+    if (pruned())
+        return output;
+
     // Spentness is unguarded and will be inconsistent during write.
     const auto reader = [&](byte_deserializer& deserial)
     {
@@ -197,11 +236,11 @@ chain::output transaction_result::output(uint32_t index) const
         for (auto out = 0u; out < index; ++out)
         {
             deserial.skip(spend_size);
-            deserial.skip(deserial.read_size_little_endian());
+            skip_compressed(deserial);
         }
 
         // Read the target output.
-        output.from_data(deserial, false);
+        output = read_output(deserial);
     };
 
     // Read and return the target output (including spender height).
@@ -210,20 +249,55 @@ chain::output transaction_result::output(uint32_t index) const
 }
 
 // Spentness is unguarded and will be inconsistent during write.
+// A pruned tx returns default/invalid transaction.
 chain::transaction transaction_result::transaction(bool witness) const
 {
     BITCOIN_ASSERT(element_);
-    chain::transaction tx;
-    auto key = hash();
+
+    if (pruned())
+        return {};
+
+    uint32_t locktime;
+    uint32_t version;
+    chain::input::list inputs;
+    chain::output::list outputs;
 
     const auto reader = [&](byte_deserializer& deserial)
     {
         deserial.skip(metadata_size);
-        tx.from_data(deserial, std::move(key), false, witness);
+        outputs.resize(deserial.read_size_little_endian());
+
+        for (auto& output: outputs)
+            output = read_output(deserial);
+
+        inputs.resize(deserial.read_size_little_endian());
+
+        for (auto& input: inputs)
+            input.from_data(deserial, false, false);
+
+        const auto lock = deserial.read_variable_little_endian();
+        const auto ver = deserial.read_variable_little_endian();
+        locktime = static_cast<uint32_t>(lock);
+        version = static_cast<uint32_t>(ver);
     };
 
     element_.read(reader);
 
+    // Witnesses are stored apart from the tx and only if it is segregated.
+    if (witness && witness_ != manager::not_allocated)
+    {
+        const auto memory = witness_manager_.get(witness_);
+        auto deserial = make_unsafe_deserializer(memory->buffer());
+
+        // There is one prefixed witness for each input.
+        for (auto& input: inputs)
+            input.set_witness(chain::witness::factory(deserial, true));
+    }
+
+    // The stored key is the tx hash, so it is cached on the tx.
+    chain::transaction tx(chain::transaction(version, locktime,
+        std::move(inputs), std::move(outputs)), hash());
+
     // TODO: populate all metadata or use methods?
     tx.metadata.link = element_.link();
     tx.metadata.existed = true;
@@ -231,9 +305,134 @@ chain::transaction transaction_result::transaction(bool witness) const
     return tx;
 }
 
+// Read a stored (minimally encoded) varint and advance past it.
+static size_t read_size(uint8_t*& data)
+{
+    auto deserial = make_unsafe_deserializer(data);
+    const auto value = deserial.read_size_little_endian();
+    data += message::variable_uint_size(value);
+    return value;
+}
+
+// Spentness is unguarded and will be inconsistent during write.
+// The wire encoding is written from the slab without constructing the tx.
+// Byte ranges that are stored as on the wire are written in place.
+bool transaction_result::to_data(writer& sink, bool witness) const
+{
+    BITCOIN_ASSERT(element_);
+
+    // The body of a pruned tx is not retained, so it cannot be written.
+    if (!element_ || pruned())
+        return false;
+
+    const auto segregated = witness && witness_ != manager::not_allocated;
+    const auto memory = element_.value();
+    auto data = memory->buffer() + metadata_size;
+
+    const auto outputs = read_size(data);
+    const auto outputs_start = data;
+
+    for (auto output = 0u; output < outputs; ++output)
+    {
+        data += spend_size;
+        auto deserial = make_unsafe_deserializer(data);
+        data += skip_compressed(deserial);
+    }
+
+    const auto inputs = read_size(data);
+    const auto inputs_start = data;
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        data += point::satoshi_fixed_size(false);
+        const auto size = read_size(data);
+        data += size + sequence_size;
+    }
+
+    // The tx header is stored last, but is first on the wire.
+    auto header = make_unsafe_deserializer(data);
+    const auto locktime = header.read_variable_little_endian();
+    const auto version = header.read_variable_little_endian();
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(version));
+
+    if (segregated)
+    {
+        sink.write_byte(witness_marker);
+        sink.write_byte(witness_flag);
+    }
+
+    // Input points are stored in compact form, scripts as on the wire.
+    sink.write_size_little_endian(inputs);
+    data = inputs_start;
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        point prevout;
+        auto deserial = make_unsafe_deserializer(data);
+        prevout.from_data(deserial, false);
+        prevout.to_data(sink, true);
+        data += point::satoshi_fixed_size(false);
+
+        const auto size = read_size(data);
+        sink.write_size_little_endian(size);
+        sink.write_bytes(data, size + sequence_size);
+        data += size + sequence_size;
+    }
+
+    // Output spend metadata is stripped and scripts decompressed.
+    sink.write_size_little_endian(outputs);
+    data = outputs_start;
+
+    for (auto output = 0u; output < outputs; ++output)
+    {
+        data += index_spend_size + height_size;
+        sink.write_bytes(data, value_size);
+        data += value_size;
+        data += decompress(sink, data);
+    }
+
+    if (segregated)
+    {
+        const auto witnesses = witness_manager_.get(witness_);
+        const auto start = witnesses->buffer();
+        auto end = start;
+
+        // Witnesses are stored prefixed, as on the wire, so are one range.
+        for (auto input = 0u; input < inputs; ++input)
+        {
+            const auto count = read_size(end);
+
+            for (auto element = 0u; element < count; ++element)
+            {
+                const auto size = read_size(end);
+                end += size;
+            }
+        }
+
+        sink.write_bytes(start, static_cast<size_t>(end - start));
+    }
+
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(locktime));
+    return sink;
+}
+
+data_chunk transaction_result::to_data(bool witness) const
+{
+    data_chunk data;
+    data_sink ostream(data);
+    ostream_writer sink(ostream);
+
+    if (!to_data(sink, witness))
+        return {};
+
+    ostream.flush();
+    return data;
+}
+
+// The inputs of a pruned tx are not retained, so the set is empty.
 inpoint_iterator transaction_result::begin() const
 {
-    return { element_ };
+    return { pruned() ? element_.terminator() : element_ };
 }
 
 inpoint_iterator transaction_result::end() const
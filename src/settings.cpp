@@ -31,12 +31,19 @@ settings::settings()
 
     flush_writes(false),
     cache_capacity(0),
+    cache_warmup_blocks(100),
+    transaction_cache_capacity(0),
+
+    // Pruning of spent tx bodies (disabled if zero).
+    prune_depth(0),
+
     file_growth_rate(5),
 
     // Hash table sizes (must be configured).
     block_table_buckets(0),
     transaction_table_buckets(0),
     payment_table_buckets(0),
+    utxo_table_buckets(0),
 
     // Minimum file sizes.
     block_table_size(1),
@@ -44,6 +51,8 @@ settings::settings()
     confirmed_index_size(1),
     transaction_index_size(1),
     transaction_table_size(1),
+    witness_table_size(1),
+    utxo_table_size(1),
     payment_index_size(1),
     payment_table_size(1),
 
@@ -63,11 +72,14 @@ settings::settings(config::settings context)
             block_table_buckets = 650000;
             transaction_table_buckets = 110000000;
             payment_table_buckets = 107000000;
+            utxo_table_buckets = 100000000;
             block_table_size = 80000000;
             candidate_index_size = 3000000;
             confirmed_index_size = 3000000;
             transaction_index_size = 3000000000;
             transaction_table_size = 220000000000;
+            witness_table_size = 80000000000;
+            utxo_table_size = 8000000000;
             payment_index_size = 100000000000;
             payment_table_size = 100000000;
             neutrino_filter_table_buckets = 650000;
@@ -81,11 +93,14 @@ settings::settings(config::settings context)
             block_table_buckets = 650000;
             transaction_table_buckets = 110000000;
             payment_table_buckets = 107000000;
+            utxo_table_buckets = 100000000;
             block_table_size = 42;
             candidate_index_size = 42;
             confirmed_index_size = 42;
             transaction_index_size = 42;
             transaction_table_size = 42;
+            witness_table_size = 42;
+            utxo_table_size = 42;
             payment_index_size = 42;
             payment_table_size = 42;
             neutrino_filter_table_buckets = 650000;
@@ -99,11 +114,14 @@ settings::settings(config::settings context)
             block_table_buckets = 650000;
             transaction_table_buckets = 110000000;
             payment_table_buckets = 107000000;
+            utxo_table_buckets = 100000000;
             block_table_size = 42;
             candidate_index_size = 42;
             confirmed_index_size = 42;
             transaction_index_size = 42;
             transaction_table_size = 42;
+            witness_table_size = 42;
+            utxo_table_size = 42;
             payment_index_size = 42;
             payment_table_size = 42;
             neutrino_filter_table_buckets = 650000;
@@ -34,12 +34,16 @@ using namespace boost::system;
 // Database file names.
 const std::string store::FLUSH_LOCK = "flush_lock";
 const std::string store::EXCLUSIVE_LOCK = "exclusive_lock";
+const std::string store::JOURNAL = "journal";
 const std::string store::BLOCK_TABLE = "block_table";
 const std::string store::CANDIDATE_INDEX = "candidate_index";
 const std::string store::CONFIRMED_INDEX = "confirmed_index";
 const std::string store::NEUTRINO_FILTER_TABLE = "neutrino_filter_table";
 const std::string store::TRANSACTION_INDEX = "transaction_index";
 const std::string store::TRANSACTION_TABLE = "transaction_table";
+const std::string store::WITNESS_TABLE = "witness_table";
+const std::string store::UTXO_TABLE = "utxo_table";
+const std::string store::OUTPUT_CACHE = "output_cache";
 const std::string store::PAYMENT_TABLE = "payment_table";
 const std::string store::PAYMENT_ROWS = "payment_rows";
 
@@ -71,6 +75,7 @@ store::store(const path& prefix, bool with_indexes, bool with_neutrino,
     flush_each_write_(flush_each_write),
     flush_lock_(prefix / FLUSH_LOCK),
     exclusive_lock_(prefix / EXCLUSIVE_LOCK),
+    journal_(prefix / JOURNAL, flush_each_write),
 
     // Content store.
     block_table(prefix / BLOCK_TABLE),
@@ -78,10 +83,15 @@ store::store(const path& prefix, bool with_indexes, bool with_neutrino,
     confirmed_index(prefix / CONFIRMED_INDEX),
     transaction_index(prefix / TRANSACTION_INDEX),
     transaction_table(prefix / TRANSACTION_TABLE),
+    witness_table(prefix / WITNESS_TABLE),
+    utxo_table(prefix / UTXO_TABLE),
 
     // Optional store.
     neutrino_filter_table(prefix / NEUTRINO_FILTER_TABLE),
 
+    // Output cache snapshot.
+    output_cache(prefix / OUTPUT_CACHE),
+
     // Optional indexes.
     payment_table(prefix / PAYMENT_TABLE),
     payment_rows(prefix / PAYMENT_ROWS)
@@ -103,6 +113,8 @@ bool store::create()
         create_file(confirmed_index) &&
         create_file(transaction_index) &&
         create_file(transaction_table) &&
+        create_file(witness_table) &&
+        create_file(utxo_table) &&
         (with_neutrino_ ? create_file(neutrino_filter_table) : true);
 
     if (!with_indexes_)
@@ -114,26 +126,38 @@ bool store::create()
         create_file(payment_rows);
 }
 
+// A remaining flush lock implies an interrupted write (or session), which is
+// restored from the journal. The journal of a store that does not flush each
+// write is restored only if the system has not restarted since (see journal).
 bool store::open()
 {
-    return exclusive_lock_.lock() && flush_lock_.try_lock() &&
-        (flush_each_write() || flush_lock_.lock_shared());
+    return exclusive_lock_.lock() &&
+        (flush_lock_.try_lock() || recover()) &&
+        journal_.open() && (flush_each_write() || flush_lock_.lock_shared());
 }
 
 bool store::close()
 {
-    return (flush_each_write() || flush_lock_.unlock_shared()) &&
+    return journal_.close() &&
+        (flush_each_write() || flush_lock_.unlock_shared()) &&
         exclusive_lock_.unlock();
 }
 
 bool store::begin_write() const
 {
+    journal_.begin();
     return !flush_each_write() || flush_lock_.lock_shared();
 }
 
+// The journal is retained if the flush fails, as is the flush lock.
+// The journal is forced to disk before the ranges it logs are flushed.
 bool store::end_write() const
 {
-    return !flush_each_write() || (flush() && flush_lock_.unlock_shared());
+    if (flush_each_write() && !(journal_.flush() && flush()))
+        return false;
+
+    return journal_.end() &&
+        (!flush_each_write() || flush_lock_.unlock_shared());
 }
 
 bool store::flush_each_write() const
@@ -141,5 +165,24 @@ bool store::flush_each_write() const
     return flush_each_write_;
 }
 
+// protected
+journal& store::write_journal()
+{
+    return journal_;
+}
+
+// private
+bool store::recover()
+{
+    const auto journal_file = prefix_ / JOURNAL;
+
+    if (!exists(journal_file) || !journal::rollback(journal_file))
+        return false;
+
+    error_code ec;
+    remove(prefix_ / FLUSH_LOCK, ec);
+    return !ec;
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/transaction_cache.hpp>
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// Capacity is divided evenly among shards, each evicting independently.
+transaction_cache::transaction_cache(size_t capacity)
+  : capacity_(capacity), hits_(1), queries_(1)
+{
+}
+
+bool transaction_cache::disabled() const
+{
+    return capacity_ == 0;
+}
+
+bool transaction_cache::empty() const
+{
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
+
+        if (!shard.links.empty())
+            return false;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return true;
+}
+
+size_t transaction_cache::size() const
+{
+    size_t total = 0;
+
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
+        total += shard.links.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return total;
+}
+
+float transaction_cache::hit_rate() const
+{
+    // These values could overflow or divide by zero, but that's okay.
+    return hits_ * 1.0f / queries_;
+}
+
+void transaction_cache::add(file_offset link, const transaction& tx)
+{
+    if (!disabled())
+        add(get_shard(link), link, tx, nullptr);
+}
+
+void transaction_cache::add(file_offset link, const transaction& tx,
+    size_t epoch)
+{
+    if (!disabled())
+        add(get_shard(link), link, tx, &epoch);
+}
+
+size_t transaction_cache::epoch(file_offset link) const
+{
+    return get_shard(link).epoch.load();
+}
+
+void transaction_cache::remove(file_offset link)
+{
+    if (disabled())
+        return;
+
+    auto& shard = get_shard(link);
+
+    // Invalidate any decode in progress, even if the link is not cached.
+    ++shard.epoch;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shard.mutex.lock_upgrade();
+
+    const auto it = shard.links.find(link);
+
+    if (it == shard.links.end())
+    {
+        shard.mutex.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    shard.mutex.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    shard.bytes -= it->second->bytes;
+    shard.recent.erase(it->second);
+    shard.links.erase(it);
+
+    shard.mutex.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void transaction_cache::clear()
+{
+    for (auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(shard.mutex);
+        ++shard.epoch;
+        shard.bytes = 0;
+        shard.recent.clear();
+        shard.links.clear();
+        ///////////////////////////////////////////////////////////////////////
+    }
+}
+
+bool transaction_cache::populate(transaction& out_tx, file_offset link,
+    bool witness) const
+{
+    if (disabled())
+        return false;
+
+    ++queries_;
+    auto& shard = get_shard(link);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    const auto it = shard.links.find(link);
+
+    // A segregated tx is cached with witness, so cannot serve without.
+    if (it == shard.links.end() || (!witness && it->second->segregated))
+        return false;
+
+    // Promote the entry to most recently used.
+    shard.recent.splice(shard.recent.begin(), shard.recent, it->second);
+    out_tx = it->second->tx;
+    ///////////////////////////////////////////////////////////////////////////
+
+    ++hits_;
+    return true;
+}
+
+// private
+// The epoch test and insertion are atomic with respect to remove.
+void transaction_cache::add(shard& shard, file_offset link,
+    const transaction& tx, const size_t* epoch)
+{
+    // The serialized size approximates the decoded size.
+    const auto limit = capacity_ / shards;
+    const auto bytes = tx.serialized_size(true, true);
+
+    if (bytes > limit)
+        return;
+
+    const auto segregated = tx.is_segregated();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    // The tx may have been decoded from metadata since changed.
+    if (epoch != nullptr && *epoch != shard.epoch.load())
+        return;
+
+    // Replace any existing entry.
+    const auto it = shard.links.find(link);
+
+    if (it != shard.links.end())
+    {
+        shard.bytes -= it->second->bytes;
+        shard.recent.erase(it->second);
+        shard.links.erase(it);
+    }
+
+    // Evict least recently used entries until the tx fits.
+    while (!shard.recent.empty() && shard.bytes + bytes > limit)
+    {
+        const auto& oldest = shard.recent.back();
+        shard.bytes -= oldest.bytes;
+        shard.links.erase(oldest.link);
+        shard.recent.pop_back();
+    }
+
+    shard.recent.push_front({ link, bytes, segregated, tx });
+    shard.links.emplace(link, shard.recent.begin());
+    shard.bytes += bytes;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+transaction_cache::shard& transaction_cache::get_shard(file_offset link) const
+{
+    return shards_[link % shards];
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -19,6 +19,8 @@
 #include <bitcoin/database/unspent_outputs.hpp>
 
 #include <cstddef>
+#include <utility>
+#include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 
 namespace libbitcoin {
@@ -27,10 +29,19 @@ namespace database {
 using namespace bc::system;
 using namespace bc::system::chain;
 
+unspent_outputs::entry::entry(unspent_transaction&& unspent, size_t bytes)
+  : unspent(std::move(unspent)), bytes(bytes), referenced(false)
+{
+}
+
+// An entry and its list and map nodes, with two compressed p2pkh outputs.
+const size_t unspent_outputs::transaction_bytes = 256;
+
 // This does not differentiate indexed-block transactions. These are treated as
 // unconfirmed, so this optimizes only for a top height fork point and tx pool.
+// Capacity is divided evenly among shards, each evicting independently.
 unspent_outputs::unspent_outputs(size_t capacity)
-  : capacity_(capacity), hits_(1), queries_(1), sequence_(0)
+  : capacity_(capacity), hits_(1), queries_(1)
 {
 }
 
@@ -41,22 +52,34 @@ bool unspent_outputs::disabled() const
 
 size_t unspent_outputs::empty() const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
 
-    return unspent_.empty();
-    ///////////////////////////////////////////////////////////////////////////
+        if (!shard.hashes.empty())
+            return false;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return true;
 }
 
 size_t unspent_outputs::size() const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    size_t total = 0;
 
-    return unspent_.size();
-    ///////////////////////////////////////////////////////////////////////////
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
+        total += shard.hashes.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return total;
 }
 
 float unspent_outputs::hit_rate() const
@@ -77,27 +100,7 @@ void unspent_outputs::add(const transaction& tx, size_t height,
             << "Output cache hit rate: " << hit_rate() << ", size: " << size();
     }
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    unique_lock lock(mutex_);
-
-    // It's been a long time since the last restart (~16 years).
-    if (sequence_ == max_uint32)
-        unspent_.clear();
-
-    // Remove the oldest entry if the buffer is at capacity.
-    if (unspent_.size() >= capacity_)
-        unspent_.right.erase(unspent_.right.begin());
-
-    // TODO: promote the unconfirmed/deconfirmed tx cache instead of
-    // replacing it.  A confirmed tx may replace the same
-    // unconfirmed/deconfirmed tx here.
-    unspent_.insert(
-    {
-        unspent_transaction{ tx, height, median_time_past, confirmed },
-        ++sequence_
-    });
-    ///////////////////////////////////////////////////////////////////////////
+    insert(unspent_transaction{ tx, height, median_time_past, confirmed });
 }
 
 // This is confirmation-independent, since the conflict is extrememly rare and
@@ -107,27 +110,27 @@ void unspent_outputs::remove(const hash_digest& tx_hash)
     if (disabled())
         return;
 
-    const unspent_transaction key{ tx_hash };
+    auto& shard = get_shard(tx_hash);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    shard.mutex.lock_upgrade();
 
     // Find the unspent tx entry.
-    const auto tx = unspent_.left.find(key);
+    const auto it = shard.hashes.find(tx_hash);
 
-    if (tx == unspent_.left.end())
+    if (it == shard.hashes.end())
     {
-        mutex_.unlock_upgrade();
+        shard.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return;
     }
 
-    mutex_.unlock_upgrade_and_lock();
+    shard.mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    unspent_.left.erase(tx);
+    erase(shard, it->second);
 
-    mutex_.unlock();
+    shard.mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -137,34 +140,34 @@ void unspent_outputs::remove(const output_point& point)
     if (disabled())
         return;
 
-    const unspent_transaction key{ point };
+    auto& shard = get_shard(point.hash());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    shard.mutex.lock_upgrade();
 
     // Find the unspent tx entry that may contain the output.
-    auto tx = unspent_.left.find(key);
+    const auto it = shard.hashes.find(point.hash());
 
-    if (tx == unspent_.left.end())
+    if (it == shard.hashes.end())
     {
-        mutex_.unlock_upgrade();
+        shard.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return;
     }
 
-    const auto outputs = tx->first.outputs();
-    mutex_.unlock_upgrade_and_lock();
+    shard.mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    auto& unspent = it->second->unspent;
 
-    // Erase the output if found at the specified index for the found tx.
-    outputs->erase(point.index());
+    // Mark spent the output at the specified index for the found tx.
+    unspent.spend(point.index());
 
     // Erase the unspent transaction if it is now fully spent.
-    if (outputs->empty())
-        unspent_.left.erase(tx);
+    if (unspent.empty())
+        erase(shard, it->second);
 
-    mutex_.unlock();
+    shard.mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -177,24 +180,25 @@ bool unspent_outputs::populate(const output_point& point,
 
     ++queries_;
     auto& prevout = point.metadata;
-    const unspent_transaction key{ point };
+    auto& shard = get_shard(point.hash());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    shared_lock lock(shard.mutex);
 
     // Find the unspent tx entry.
-    const auto tx = unspent_.left.find(key);
-    if (tx == unspent_.left.end())
+    const auto it = shard.hashes.find(point.hash());
+    if (it == shard.hashes.end())
         return false;
 
     // Find the output at the specified index for the found unspent tx.
-    const auto& transaction = tx->first;
-    const auto outputs = transaction.outputs();
-    const auto output = outputs->find(point.index());
-    if (output == outputs->end())
+    const auto& transaction = it->second->unspent;
+    if (!transaction.populate(prevout.cache, point.index()))
         return false;
 
+    // Give the entry a second chance, readers do not contend on the hand.
+    it->second->referenced.store(true);
+
     ++hits_;
     const auto prevout_height = transaction.height();
 
@@ -214,11 +218,141 @@ bool unspent_outputs::populate(const output_point& point,
     prevout.height = prevout_height;
     prevout.coinbase = transaction.is_coinbase();
     prevout.median_time_past = transaction.median_time_past();
-    prevout.cache = output->second;
 
     return true;
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// Only confirmed entries are saved, as the pool is not persistent.
+bool unspent_outputs::save(const boost::filesystem::path& file,
+    const hash_digest& top) const
+{
+    if (disabled())
+        return false;
+
+    ofstream stream(file.string(), std::ios::binary);
+    ostream_writer sink(stream);
+    sink.write_hash(top);
+
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
+
+        for (const auto& element: shard.ring)
+        {
+            if (element.unspent.is_confirmed())
+            {
+                sink.write_byte(1);
+                element.unspent.to_data(sink);
+            }
+        }
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    sink.write_byte(0);
+    stream.flush();
+    return sink;
+}
+
+bool unspent_outputs::load(const boost::filesystem::path& file,
+    const hash_digest& top)
+{
+    if (disabled())
+        return false;
+
+    ifstream stream(file.string(), std::ios::binary);
+
+    if (!stream.good())
+        return false;
+
+    istream_reader source(stream);
+
+    // The snapshot is valid only for the confirmed chain it was taken from.
+    if (source.read_hash() != top || !source)
+        return false;
+
+    size_t count = 0;
+
+    while (source.read_byte() == 1)
+    {
+        unspent_transaction unspent(null_hash);
+
+        if (!unspent.from_data(source))
+            return false;
+
+        insert(std::move(unspent));
+        ++count;
+    }
+
+    LOG_DEBUG(LOG_DATABASE)
+        << "Loaded output cache snapshot of " << count << " transactions.";
+
+    return source;
+}
+
+// private
+void unspent_outputs::insert(unspent_transaction&& unspent)
+{
+    const auto bytes = sizeof(entry) + unspent.bytes();
+    const auto limit = capacity_ / shards;
+
+    if (bytes > limit)
+        return;
+
+    auto& shard = get_shard(unspent.hash());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    // TODO: promote the unconfirmed/deconfirmed tx cache instead of
+    // replacing it.  A confirmed tx may replace the same
+    // unconfirmed/deconfirmed tx here.
+    const auto it = shard.hashes.find(unspent.hash());
+
+    if (it != shard.hashes.end())
+        erase(shard, it->second);
+
+    // Sweep the hand, sparing (once) each entry referenced since last pass.
+    while (!shard.ring.empty() && shard.bytes + bytes > limit)
+    {
+        if (shard.hand == shard.ring.end())
+            shard.hand = shard.ring.begin();
+
+        if (shard.hand->referenced.exchange(false))
+            ++shard.hand;
+        else
+            erase(shard, shard.hand);
+    }
+
+    // Insert behind the hand, so that it is the last to be swept.
+    const auto inserted = shard.ring.emplace(shard.hand, std::move(unspent),
+        bytes);
+    shard.hashes.emplace(inserted->unspent.hash(), inserted);
+    shard.bytes += bytes;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Caller must hold the shard's unique lock.
+void unspent_outputs::erase(shard& shard, entries::iterator it)
+{
+    if (shard.hand == it)
+        ++shard.hand;
+
+    shard.bytes -= it->bytes;
+    shard.hashes.erase(it->unspent.hash());
+    shard.ring.erase(it);
+}
+
+// private
+unspent_outputs::shard& unspent_outputs::get_shard(
+    const hash_digest& tx_hash) const
+{
+    return shards_[tx_hash.front() % shards];
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <utility>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/compression.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -30,13 +31,63 @@ using namespace bc::system;
 using namespace bc::system::chain;
 using namespace bc::system::machine;
 
+static constexpr auto offset_size = sizeof(uint32_t);
+static constexpr auto value_size = sizeof(uint64_t);
+
+static inline size_t bitmap_size(size_t count)
+{
+    return (count + 7u) / 8u;
+}
+
+// True if each output offset addresses a value and compressed script within
+// the buffer, so that a corrupt snapshot cannot drive reads beyond it.
+static bool is_bounded(data_chunk& outputs, uint32_t count)
+{
+    const auto size = outputs.size();
+    const auto offsets = bitmap_size(count);
+    const auto entries = offsets + count * offset_size;
+
+    if (size < entries)
+        return false;
+
+    auto indexes = make_unsafe_deserializer(outputs.data() + offsets);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const size_t offset = indexes.read_4_bytes_little_endian();
+
+        if (offset < entries || size - offset <= value_size)
+            return false;
+
+        // The script tag is a varint, sized by its first byte.
+        const auto tag = offset + value_size;
+        const auto prefix = outputs[tag];
+        const size_t tag_size = prefix < varint_two_bytes ? 1u :
+            prefix == varint_two_bytes ? 3u :
+            prefix == varint_four_bytes ? 5u : 9u;
+
+        if (size - tag < tag_size)
+            return false;
+
+        // The payload is skipped, not read.
+        auto deserial = make_unsafe_deserializer(outputs.data() + tag);
+
+        if (size - tag < skip_compressed(deserial))
+            return false;
+    }
+
+    return true;
+}
+
 unspent_transaction::unspent_transaction(unspent_transaction&& other)
   : height_(other.height_),
     median_time_past_(other.median_time_past_),
     is_coinbase_(other.is_coinbase_),
     is_confirmed_(other.is_confirmed_),
     hash_(std::move(other.hash_)),
-    outputs_(other.outputs_)
+    count_(other.count_),
+    unspent_(other.unspent_),
+    outputs_(std::move(other.outputs_))
 {
 }
 
@@ -46,6 +97,8 @@ unspent_transaction::unspent_transaction(const unspent_transaction& other)
     is_coinbase_(other.is_coinbase_),
     is_confirmed_(other.is_confirmed_),
     hash_(other.hash_),
+    count_(other.count_),
+    unspent_(other.unspent_),
     outputs_(other.outputs_)
 {
 }
@@ -56,7 +109,8 @@ unspent_transaction::unspent_transaction(const hash_digest& hash)
     is_coinbase_(false),
     is_confirmed_(false),
     hash_(hash),
-    outputs_(std::make_shared<output_map>())
+    count_(0),
+    unspent_(0)
 {
 }
 
@@ -72,15 +126,31 @@ unspent_transaction::unspent_transaction(const chain::transaction& tx,
     is_coinbase_(tx.is_coinbase()),
     is_confirmed_(confirmed),
     hash_(tx.hash()),
-    outputs_(std::make_shared<output_map>())
+    count_(safe_unsigned<uint32_t>(tx.outputs().size())),
+    unspent_(count_)
 {
     const auto& outputs = tx.outputs();
-    const auto size = safe_unsigned<uint32_t>(outputs.size());
-    outputs_->reserve(size);
+    const auto offsets = bitmap_size(count_);
+    const auto entries = offsets + count_ * offset_size;
+    auto size = entries;
+
+    for (const auto& output: outputs)
+        size += value_size + compressed_size(output.script());
 
-    // TODO: consider eliminating the byte buffer in favor of ops::list only.
-    for (auto index = 0u; index < size; ++index)
-        (*outputs_)[index] = outputs[index];
+    // A single exact-size allocation, with all outputs marked unspent.
+    outputs_.resize(size, 0x00);
+
+    auto offset = entries;
+    auto indexes = make_unsafe_serializer(outputs_.data() + offsets);
+    auto serial = make_unsafe_serializer(outputs_.data() + entries);
+
+    for (const auto& output: outputs)
+    {
+        indexes.write_4_bytes_little_endian(static_cast<uint32_t>(offset));
+        serial.write_8_bytes_little_endian(output.value());
+        compress(serial, output.script());
+        offset += value_size + compressed_size(output.script());
+    }
 }
 
 const hash_digest& unspent_transaction::hash() const
@@ -108,12 +178,81 @@ bool unspent_transaction::is_confirmed() const
     return is_confirmed_;
 }
 
-unspent_transaction::output_map_ptr unspent_transaction::outputs() const
+size_t unspent_transaction::size() const
+{
+    return unspent_;
+}
+
+bool unspent_transaction::empty() const
 {
-    return outputs_;
+    return unspent_ == 0;
 }
 
-// For the purpose of bimap identity only the tx hash matters.
+size_t unspent_transaction::bytes() const
+{
+    return outputs_.capacity();
+}
+
+bool unspent_transaction::populate(output& out_output, uint32_t index) const
+{
+    if (index >= count_ || is_spent(index))
+        return false;
+
+    const auto offsets = bitmap_size(count_) + index * offset_size;
+    auto indexes = make_unsafe_deserializer(outputs_.data() + offsets);
+    const auto offset = indexes.read_4_bytes_little_endian();
+
+    auto deserial = make_unsafe_deserializer(outputs_.data() + offset);
+    const auto value = deserial.read_8_bytes_little_endian();
+    out_output = output(value, decompress(deserial));
+    return true;
+}
+
+bool unspent_transaction::spend(uint32_t index)
+{
+    if (index >= count_ || is_spent(index))
+        return false;
+
+    outputs_[index / 8u] |= (1u << (index % 8u));
+    --unspent_;
+    return true;
+}
+
+void unspent_transaction::to_data(writer& sink) const
+{
+    sink.write_hash(hash_);
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(height_));
+    sink.write_4_bytes_little_endian(median_time_past_);
+    sink.write_byte(is_coinbase_ ? 1 : 0);
+    sink.write_byte(is_confirmed_ ? 1 : 0);
+    sink.write_4_bytes_little_endian(count_);
+    sink.write_4_bytes_little_endian(unspent_);
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(outputs_.size()));
+    sink.write_bytes(outputs_);
+}
+
+bool unspent_transaction::from_data(reader& source)
+{
+    hash_ = source.read_hash();
+    height_ = source.read_4_bytes_little_endian();
+    median_time_past_ = source.read_4_bytes_little_endian();
+    is_coinbase_ = source.read_byte() != 0;
+    is_confirmed_ = source.read_byte() != 0;
+    count_ = source.read_4_bytes_little_endian();
+    unspent_ = source.read_4_bytes_little_endian();
+    outputs_ = source.read_bytes(source.read_4_bytes_little_endian());
+
+    // The buffer must contain the bitmap, offsets and addressed outputs.
+    return source && unspent_ <= count_ && is_bounded(outputs_, count_);
+}
+
+// private
+bool unspent_transaction::is_spent(uint32_t index) const
+{
+    return (outputs_[index / 8u] & (1u << (index % 8u))) != 0;
+}
+
+// For the purpose of identity only the tx hash matters.
 bool unspent_transaction::operator==(const unspent_transaction& other) const
 {
     return hash_ == other.hash_;
@@ -127,7 +266,9 @@ unspent_transaction& unspent_transaction::operator=(
     is_coinbase_ = other.is_coinbase_;
     is_confirmed_ = other.is_confirmed_;
     hash_ = std::move(other.hash_);
-    outputs_ = other.outputs_;
+    count_ = other.count_;
+    unspent_ = other.unspent_;
+    outputs_ = std::move(other.outputs_);
     return *this;
 }
 
@@ -139,6 +280,8 @@ unspent_transaction& unspent_transaction::operator=(
     is_coinbase_ = other.is_coinbase_;
     is_confirmed_ = other.is_confirmed_;
     hash_ = other.hash_;
+    count_ = other.count_;
+    unspent_ = other.unspent_;
     outputs_ = other.outputs_;
     return *this;
 }
@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/update_pipeline.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/data_base.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// Updates are concurrent only when write flushing is disabled, otherwise
+// data_base::update serializes them (and the pipeline only reorders).
+update_pipeline::update_pipeline(data_base& database, size_t first_height,
+    size_t threads, size_t limit, handler complete)
+  : database_(database),
+    limit_(limit),
+    complete_(complete),
+    stopped_(false),
+    next_(first_height),
+    releasing_(false)
+{
+    const auto count = std::max(threads, size_t(1));
+    threads_.reserve(count);
+
+    for (size_t thread = 0; thread < count; ++thread)
+        threads_.emplace_back(&update_pipeline::work, this);
+}
+
+update_pipeline::~update_pipeline()
+{
+    stop();
+}
+
+bool update_pipeline::enqueue(block_const_ptr block, size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+
+        if (stopped_)
+            return false;
+
+        queue_.emplace_back(block, height);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    queue_condition_.notify_one();
+    return true;
+}
+
+void update_pipeline::stop()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        stopped_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    queue_condition_.notify_all();
+
+    for (auto& thread: threads_)
+        if (thread.joinable())
+            thread.join();
+
+    std::map<size_t, result> stranded;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(ready_mutex_);
+        stranded.swap(ready_);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Workers are joined, so these are completed in order and not overlapped.
+    for (const auto& entry: stranded)
+        complete_(error::service_stopped, entry.second.second, entry.first);
+}
+
+// Workers drain the queue before exiting on stop.
+void update_pipeline::work()
+{
+    while (true)
+    {
+        item next;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_condition_.wait(lock, [this]()
+            {
+                return stopped_ || !queue_.empty();
+            });
+
+            if (queue_.empty())
+                return;
+
+            next = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        const auto ec = database_.update(*next.first, next.second);
+        release(ec, next.first, next.second);
+    }
+}
+
+// The handler is invoked outside of the lock, by whichever thread holds the
+// release, so that hand-off is strictly ordered without blocking workers.
+// Each update is completed once, a rejected one as soon as it is released.
+void update_pipeline::release(const code& ec, block_const_ptr block,
+    size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(ready_mutex_);
+
+        // A late or duplicate update is failed, as its height is taken.
+        if (height < next_ ||
+            !ready_.emplace(height, std::make_pair(ec, block)).second)
+            rejected_.emplace_back(std::make_pair(error::operation_failed,
+                block), height);
+
+        // The releasing thread will hand off this update if it is next.
+        if (releasing_)
+            return;
+
+        releasing_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    while (true)
+    {
+        result next;
+        size_t next_height;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex_);
+
+            if (!rejected_.empty())
+            {
+                next = std::move(rejected_.front().first);
+                next_height = rejected_.front().second;
+                rejected_.pop_front();
+            }
+            else if (!ready_.empty() && ready_.begin()->first == next_)
+            {
+                next = std::move(ready_.begin()->second);
+                ready_.erase(ready_.begin());
+                next_height = next_++;
+            }
+            else if (ready_.size() > limit_)
+            {
+                // The missing height is failed so the buffer cannot grow.
+                next = std::make_pair(error::operation_failed, nullptr);
+                next_height = next_++;
+            }
+            else
+            {
+                releasing_ = false;
+                return;
+            }
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        complete_(next.first, next.second, next_height);
+    }
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -32,7 +32,8 @@ using namespace bc::system::chain;
 static hash_digest get_block(const block_database& blocks,
     size_t height, bool candidate)
 {
-    return blocks.get(height, candidate).hash();
+    block_database::index_entry entry;
+    return blocks.get(entry, height, candidate) ? entry.hash : null_hash;
 }
 
 static bool get_is_empty_block(const block_database& blocks,
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+BOOST_AUTO_TEST_SUITE(compression_tests)
+
+#define P2PKH "76a914fe06e7b4c88a719e92373de489c08244aee4520b88ac"
+#define P2SH "a914748284390f9e263a4b766a75d0633c50426eb87587"
+#define P2WPKH "0014751e76e8199196d454941c45d1b3a323f1433bd6"
+#define P2WSH "00201863143c14c5166804bd19203356da136c985678cd4d27a1b8c6329604903262"
+#define P2TR "5120a60869f0dbcf1dc659c9cecbaf8050135ea9e8cdc487053f1dc6880949dc684c"
+#define NON_TEMPLATE "6a0b68656c6c6f20776f726c64"
+
+static script to_script(const std::string& hex)
+{
+    data_chunk data;
+    BOOST_REQUIRE(decode_base16(data, hex));
+    return script::factory(data, false);
+}
+
+static data_chunk to_compressed(const script& script)
+{
+    data_chunk data(compressed_size(script));
+    auto serial = make_unsafe_serializer(data.data());
+    compress(serial, script);
+    return data;
+}
+
+static script from_compressed(data_chunk& data)
+{
+    auto deserial = make_unsafe_deserializer(data.data());
+    return decompress(deserial);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__p2pkh__tag_and_hash)
+{
+    const auto script = to_script(P2PKH);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + short_hash_size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), 0u);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__p2sh__tag_and_hash)
+{
+    const auto script = to_script(P2SH);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + short_hash_size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), 1u);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__p2wpkh__tag_and_hash)
+{
+    const auto script = to_script(P2WPKH);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + short_hash_size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), 2u);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__p2wsh__tag_and_hash)
+{
+    const auto script = to_script(P2WSH);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + hash_size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), 3u);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__p2tr__tag_and_key)
+{
+    const auto script = to_script(P2TR);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + hash_size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), 4u);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__non_template__tag_and_script)
+{
+    const auto script = to_script(NON_TEMPLATE);
+    const auto size = script.serialized_size(false);
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u + size);
+    BOOST_REQUIRE_EQUAL(compressed.front(), script_templates + size);
+    BOOST_REQUIRE(from_compressed(compressed) == script);
+}
+
+BOOST_AUTO_TEST_CASE(compression__compress__empty__tag_only)
+{
+    const script script;
+    auto compressed = to_compressed(script);
+    BOOST_REQUIRE_EQUAL(compressed.size(), 1u);
+    BOOST_REQUIRE_EQUAL(compressed.front(), script_templates);
+    BOOST_REQUIRE(from_compressed(compressed).to_data(false).empty());
+}
+
+BOOST_AUTO_TEST_CASE(compression__skip_compressed__template_and_non_template__expected_position)
+{
+    const auto first = to_script(P2WSH);
+    const auto second = to_script(NON_TEMPLATE);
+    const auto third = to_script(P2PKH);
+    data_chunk data(compressed_size(first) + compressed_size(second) +
+        compressed_size(third));
+
+    auto serial = make_unsafe_serializer(data.data());
+    compress(serial, first);
+    compress(serial, second);
+    compress(serial, third);
+
+    auto deserial = make_unsafe_deserializer(data.data());
+    skip_compressed(deserial);
+    skip_compressed(deserial);
+    BOOST_REQUIRE(decompress(deserial) == third);
+    BOOST_REQUIRE(deserial);
+}
+
+BOOST_AUTO_TEST_CASE(compression__skip_compressed__unspendable__expected)
+{
+    const auto first = to_script(P2PKH);
+    const auto second = to_script(NON_TEMPLATE);
+    const auto third = to_script("");
+    data_chunk data(compressed_size(first) + compressed_size(second) +
+        compressed_size(third));
+
+    auto serial = make_unsafe_serializer(data.data());
+    compress(serial, first);
+    compress(serial, second);
+    compress(serial, third);
+
+    auto unspendable = true;
+    auto deserial = make_unsafe_deserializer(data.data());
+    BOOST_REQUIRE_EQUAL(skip_compressed(deserial, unspendable),
+        compressed_size(first));
+    BOOST_REQUIRE(!unspendable);
+    BOOST_REQUIRE_EQUAL(skip_compressed(deserial, unspendable),
+        compressed_size(second));
+    BOOST_REQUIRE(unspendable);
+    BOOST_REQUIRE_EQUAL(skip_compressed(deserial, unspendable),
+        compressed_size(third));
+    BOOST_REQUIRE(!unspendable);
+    BOOST_REQUIRE(deserial);
+}
+
+BOOST_AUTO_TEST_CASE(compression__decompress__writer_template_and_non_template__wire_scripts)
+{
+    const auto first = to_script(P2PKH);
+    const auto second = to_script(NON_TEMPLATE);
+    data_chunk data(compressed_size(first) + compressed_size(second));
+
+    auto serial = make_unsafe_serializer(data.data());
+    compress(serial, first);
+    compress(serial, second);
+
+    data_chunk wire;
+    data_sink ostream(wire);
+    ostream_writer sink(ostream);
+    const auto size = decompress(sink, data.data());
+    BOOST_REQUIRE_EQUAL(size, compressed_size(first));
+    BOOST_REQUIRE_EQUAL(decompress(sink, data.data() + size),
+        compressed_size(second));
+    ostream.flush();
+
+    BOOST_REQUIRE(wire == build_chunk({ first.to_data(true),
+        second.to_data(true) }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -279,6 +279,11 @@ public:
         return data_base::push_block(block, height);
     }
 
+    void stop_filter_loader()
+    {
+        data_base::stop_filter_loader();
+    }
+
     code store(const transaction& tx, uint32_t forks)
     {
         return data_base::store(tx, forks);
@@ -294,6 +299,11 @@ public:
         return data_base::pop_block(out_block, height);
     }
 
+    code pop_block(hash_digest& out_hash, size_t height)
+    {
+        return data_base::pop_block(out_hash, height);
+    }
+
     bool pop_above(header_const_ptr_list_ptr headers,
         const config::checkpoint& fork_point)
     {
@@ -646,6 +656,41 @@ BOOST_AUTO_TEST_CASE(data_base__pop_block__confirmed___success)
     test_heights(instance, 1u, 0u);
 }
 
+BOOST_AUTO_TEST_CASE(data_base__pop_block__link_only___success)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    store_block_transactions(instance, block1, 1);
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.push_block(block1, 1), error::success);
+
+    // Setup ends.
+
+    hash_digest out_hash;
+    BOOST_REQUIRE_EQUAL(instance.pop_block(out_hash, 1), error::success);
+
+    // Test conditions.
+
+    BOOST_REQUIRE(out_hash == block1.hash());
+    test_block_not_exists(instance, block1, false);
+    test_heights(instance, 1u, 0u);
+}
+
 BOOST_AUTO_TEST_CASE(data_base__push_all_and_update__already_candidated___success)
 {
     create_directory(DIRECTORY);
@@ -987,7 +1032,7 @@ BOOST_AUTO_TEST_CASE(data_base__confirm__not_existing___failure)
 
     // Setup ends.
 
-    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 1), error::operation_failed);
+    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 1), error::not_found);
 
     // Test conditions.
 
@@ -1019,7 +1064,7 @@ BOOST_AUTO_TEST_CASE(data_base__confirm__incorrect_height___failure)
 
     // Setup ends.
 
-    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 2), error::operation_failed);
+    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 2), error::store_block_invalid_height);
 }
 
 BOOST_AUTO_TEST_CASE(data_base__confirm__missing_parent___failure)
@@ -1044,7 +1089,7 @@ BOOST_AUTO_TEST_CASE(data_base__confirm__missing_parent___failure)
 
     // Setup ends.
 
-    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 1), error::operation_failed);
+    BOOST_REQUIRE_EQUAL(instance.confirm(block1.hash(), 1), error::not_found);
 }
 
 BOOST_AUTO_TEST_CASE(data_base__confirm__already_candidated___success)
@@ -1091,6 +1136,313 @@ BOOST_AUTO_TEST_CASE(data_base__confirm__already_candidated___success)
     }
 }
 
+BOOST_AUTO_TEST_CASE(data_base__confirm__batch_of_two___success)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = true;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    store_block_transactions(instance, block1, 1);
+    store_block_transactions(instance, block2, 1);
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.push_header(block2.header(), 2, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block2), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block2, 2), error::success);
+    test_heights(instance, 2u, 0u);
+
+    // Setup ends.
+
+    BOOST_REQUIRE_EQUAL(instance.confirm({ block1.hash(), block2.hash() }, 1), error::success);
+
+    // Test conditions.
+
+    test_heights(instance, 2u, 2u);
+    BOOST_REQUIRE(instance.blocks().get(1, false).hash() == block1.hash());
+    BOOST_REQUIRE(instance.blocks().get(2, false).hash() == block2.hash());
+    test_block_exists(instance, 2, block2, false, false);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__confirm__batch_with_missing_block__not_found_nothing_confirmed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = true;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    store_block_transactions(instance, block1, 1);
+    store_block_transactions(instance, block2, 1);
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.push_header(block2.header(), 2, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block2), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block2, 2), error::success);
+
+    // Setup ends.
+
+    BOOST_REQUIRE_EQUAL(instance.confirm({ block1.hash(), null_hash }, 1), error::not_found);
+
+    // Test conditions.
+
+    test_heights(instance, 2u, 0u);
+
+    // The failed batch did not leave the write open.
+    BOOST_REQUIRE_EQUAL(instance.confirm({ block1.hash(), block2.hash() }, 1), error::success);
+    test_heights(instance, 2u, 2u);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__confirm__async_adjacent___success)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    store_block_transactions(instance, block1, 1);
+    store_block_transactions(instance, block2, 1);
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.push_header(block2.header(), 2, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block2), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block2, 2), error::success);
+
+    // Setup ends.
+
+    std::promise<code> promise1;
+    std::promise<code> promise2;
+    instance.confirm(block1.hash(), 1, [&](const code& ec) { promise1.set_value(ec); });
+    instance.confirm(block2.hash(), 2, [&](const code& ec) { promise2.set_value(ec); });
+    BOOST_REQUIRE_EQUAL(promise1.get_future().get(), error::success);
+    BOOST_REQUIRE_EQUAL(promise2.get_future().get(), error::success);
+
+    // Test conditions.
+
+    BOOST_REQUIRE_EQUAL(instance.write_queue_depth(), 0u);
+    test_heights(instance, 2u, 2u);
+    BOOST_REQUIRE(instance.blocks().get(2, false).hash() == block2.hash());
+
+    // Writes after close are not queued.
+    BOOST_REQUIRE(instance.close());
+    std::promise<code> promise3;
+    instance.confirm(block2.hash(), 3, [&](const code& ec) { promise3.set_value(ec); });
+    BOOST_REQUIRE_EQUAL(promise3.get_future().get(), error::service_stopped);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__confirm__async_adjacent_second_missing__first_confirmed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    store_block_transactions(instance, block1, 1);
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE_EQUAL(instance.candidate(block1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.update(block1, 1), error::success);
+
+    // Setup ends.
+
+    std::promise<code> promise1;
+    std::promise<code> promise2;
+    instance.confirm(block1.hash(), 1, [&](const code& ec) { promise1.set_value(ec); });
+    instance.confirm(null_hash, 2, [&](const code& ec) { promise2.set_value(ec); });
+    BOOST_REQUIRE_EQUAL(promise1.get_future().get(), error::success);
+    BOOST_REQUIRE_EQUAL(promise2.get_future().get(), error::not_found);
+
+    // Test conditions.
+
+    test_heights(instance, 1u, 1u);
+    BOOST_REQUIRE(instance.blocks().get(1, false).hash() == block1.hash());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__begin_read__chain_write__not_current)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto snapshot = instance.begin_read();
+    BOOST_REQUIRE(instance.is_current(snapshot));
+    BOOST_REQUIRE_EQUAL(snapshot.candidate_height, 0u);
+    BOOST_REQUIRE_EQUAL(snapshot.confirmed_height, 0u);
+
+    // Transaction pool writes do not change the chain.
+    store_block_transactions(instance, block1, 1);
+    BOOST_REQUIRE(instance.is_current(snapshot));
+
+    BOOST_REQUIRE_EQUAL(instance.push_header(block1.header(), 1, 100), error::success);
+    BOOST_REQUIRE(!instance.is_current(snapshot));
+
+    size_t reads = 0;
+    instance.read([&](const data_base::read_snapshot& current)
+    {
+        ++reads;
+        BOOST_REQUIRE_EQUAL(current.candidate_height, 1u);
+        BOOST_REQUIRE(instance.blocks().get(current.candidate_height, true).hash() == block1.hash());
+    });
+
+    BOOST_REQUIRE_EQUAL(reads, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__open__after_create__tables_opened_filters_ready_after_load)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings, true, true);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    genesis.header().metadata.neutrino_filter = std::make_shared<block_filter>(
+        neutrino_filter_type, genesis.hash(), null_hash, data_chunk{ 0 });
+    BOOST_REQUIRE(instance.create(genesis));
+    BOOST_REQUIRE(instance.close());
+
+    BOOST_REQUIRE(instance.open());
+    test_block_exists(instance, 0, genesis, true, false);
+
+    // Checkpoints are populated in the background following open.
+    instance.stop_filter_loader();
+    BOOST_REQUIRE(instance.filter_checkpoints_ready());
+    BOOST_REQUIRE(instance.neutrino_filters().checkpoints().empty());
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__reorganize__after_open_filters_loading__success)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings, false, true);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    genesis.header().metadata.neutrino_filter = std::make_shared<block_filter>(
+        neutrino_filter_type, genesis.hash(), null_hash, data_chunk{ 0 });
+    BOOST_REQUIRE(instance.create(genesis));
+    BOOST_REQUIRE(instance.close());
+    BOOST_REQUIRE(instance.open());
+
+    const auto outgoing_blocks = std::make_shared<block_const_ptr_list>();
+    const auto incoming_blocks = std::make_shared<const block_const_ptr_list>();
+
+    // Setup ends.
+
+    // The reorganization awaits the background checkpoint load.
+    BOOST_REQUIRE_EQUAL(instance.reorganize(config::checkpoint(genesis.hash(), 0), incoming_blocks, outgoing_blocks), error::success);
+
+    // Test conditions.
+
+    BOOST_REQUIRE(instance.filter_checkpoints_ready());
+    BOOST_REQUIRE(outgoing_blocks->empty());
+    test_heights(instance, 0u, 0u);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__metrics_report__after_create__push_and_flush_recorded)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = true;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    BOOST_REQUIRE(instance.create(genesis));
+
+    const auto report = instance.metrics_report();
+    const auto& push = report.operations[metrics::push];
+    const auto& flush = report.operations[metrics::flush];
+    BOOST_REQUIRE_EQUAL(push.name, "push");
+    BOOST_REQUIRE_EQUAL(push.units, 1u);
+    BOOST_REQUIRE_EQUAL(push.latency.count, 1u);
+    BOOST_REQUIRE_EQUAL(push.lock_wait.count, 1u);
+    BOOST_REQUIRE_GE(flush.latency.count, 1u);
+    BOOST_REQUIRE_EQUAL(report.operations[metrics::store].latency.count, 0u);
+    BOOST_REQUIRE(instance.close());
+}
+
 /// update
 
 #ifndef NDEBUG
@@ -1522,6 +1874,54 @@ BOOST_AUTO_TEST_CASE(data_base__reorganize__pop_and_push__success)
 
 /// reorganize blocks
 
+BOOST_AUTO_TEST_CASE(data_base__reorganize__fork_at_prune_horizon__failure)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+    settings.prune_depth = 1;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    BOOST_REQUIRE(instance.create(genesis));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.push(block2, 2), error::success);
+    BOOST_REQUIRE(instance.blocks().get(1, false).pruned());
+    BOOST_REQUIRE(!instance.blocks().get(2, false).pruned());
+
+    auto block3 = read_block(MAINNET_BLOCK3);
+    auto block3_header = block3.header();
+    block3_header.set_previous_block_hash(genesis.hash());
+    block3.set_header(block3_header);
+
+    const auto outgoing_blocks = std::make_shared<block_const_ptr_list>();
+    const auto incoming_blocks = std::make_shared<const block_const_ptr_list>(block_const_ptr_list
+    {
+        std::make_shared<const message::block>(block3)
+    });
+
+    // Setup ends.
+
+    BOOST_REQUIRE_EQUAL(instance.reorganize(config::checkpoint(genesis.hash(), 0), incoming_blocks, outgoing_blocks), error::operation_failed);
+    BOOST_REQUIRE_EQUAL(instance.reorganize(config::checkpoint(block1.hash(), 1), incoming_blocks, outgoing_blocks), error::operation_failed);
+
+    // Test conditions.
+
+    test_heights(instance, 2u, 2u);
+    BOOST_REQUIRE(outgoing_blocks->empty());
+    BOOST_REQUIRE(instance.blocks().get(2, false).hash() == block2.hash());
+}
+
 BOOST_AUTO_TEST_CASE(data_base__reorganize2__pop_and_push__success)
 {
     create_directory(DIRECTORY);
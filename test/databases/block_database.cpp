@@ -77,6 +77,264 @@ BOOST_AUTO_TEST_CASE(block_database__get__not_found__success)
     BOOST_REQUIRE(!instance.get(0, false));
 }
 
+BOOST_AUTO_TEST_CASE(block_database__promote__by_link__expected_state)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block0 = settings.genesis_block;
+    block0.set_transactions({ random_tx(0), random_tx(1) });
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+    BOOST_REQUIRE(instance.create());
+
+    const auto link = instance.store(block0.header(), 0, 0);
+    BOOST_REQUIRE_EQUAL(instance.get(block0.hash()).link(), link);
+
+    BOOST_REQUIRE(instance.promote(link, 0, true));
+    BOOST_REQUIRE(instance.update_transactions(link, block0));
+    BOOST_REQUIRE(instance.validate(link, error::success));
+    BOOST_REQUIRE(instance.promote(link, 0, false));
+
+    auto result = instance.get(0, false);
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE(result.hash() == block0.hash());
+    BOOST_REQUIRE_EQUAL(result.transaction_count(), 2u);
+    BOOST_REQUIRE_EQUAL(result.state(), block_state::valid | block_state::confirmed);
+
+    BOOST_REQUIRE(instance.demote(link, 0, false));
+    BOOST_REQUIRE(instance.demote(link, 0, true));
+    BOOST_REQUIRE(!instance.get(0, true));
+    BOOST_REQUIRE(!instance.get(0, false));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__prune__confirmed__pruned_state_retained)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block0 = settings.genesis_block;
+    block0.set_transactions({ random_tx(0), random_tx(1) });
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+    BOOST_REQUIRE(instance.create());
+
+    const auto link = instance.store(block0.header(), 0, 0);
+    BOOST_REQUIRE(instance.promote(link, 0, true));
+    BOOST_REQUIRE(instance.update_transactions(link, block0));
+    BOOST_REQUIRE(instance.validate(link, error::success));
+
+    // Only a confirmed block may be pruned.
+    BOOST_REQUIRE(!instance.prune(link));
+    BOOST_REQUIRE(!instance.get(0, true).pruned());
+
+    BOOST_REQUIRE(instance.promote(link, 0, false));
+    BOOST_REQUIRE(instance.prune(link));
+
+    const auto result = instance.get(0, false);
+    BOOST_REQUIRE(result.pruned());
+    BOOST_REQUIRE_EQUAL(result.state(), block_state::valid | block_state::confirmed | block_state::pruned);
+
+    block_database::index_entry entry;
+    BOOST_REQUIRE(instance.get(entry, 0, false));
+    BOOST_REQUIRE_EQUAL(entry.state, result.state());
+
+    // Deconfirmation retains the pruned state.
+    BOOST_REQUIRE(instance.demote(link, 0, false));
+    BOOST_REQUIRE(instance.get(block0.hash()).pruned());
+}
+
+BOOST_AUTO_TEST_CASE(block_database__relocate__all_links__relocated)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block0 = settings.genesis_block;
+    block0.set_transactions({ random_tx(0), random_tx(1) });
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+    BOOST_REQUIRE(instance.create());
+
+    const auto link = instance.store(block0.header(), 0, 0);
+    BOOST_REQUIRE(instance.update_transactions(link, block0));
+    BOOST_REQUIRE_EQUAL(instance.transaction_links(), 2u);
+
+    const auto relocate = [](file_offset link)
+    {
+        return link + 42;
+    };
+
+    instance.relocate(relocate, 1, 2);
+    const auto result1 = instance.get(block0.hash());
+    BOOST_REQUIRE_EQUAL(result1.transaction_count(), 2u);
+    auto it1 = result1.begin();
+    BOOST_REQUIRE_EQUAL(*it1++, 0u);
+    BOOST_REQUIRE_EQUAL(*it1++, 43u);
+
+    instance.relocate(relocate, 0, 1);
+    const auto result2 = instance.get(block0.hash());
+    auto it2 = result2.begin();
+    BOOST_REQUIRE_EQUAL(*it2++, 42u);
+    BOOST_REQUIRE_EQUAL(*it2++, 43u);
+    BOOST_REQUIRE(it2 == result2.end());
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get__index_entry__tracks_index_across_open)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const chain::block block0 = settings.genesis_block;
+    const auto& header0 = block0.header();
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+
+    {
+        block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+        BOOST_REQUIRE(instance.create());
+
+        const auto link = instance.store(header0, 0, 42);
+        BOOST_REQUIRE(instance.promote(link, 0, true));
+
+        block_database::index_entry entry;
+        BOOST_REQUIRE(instance.get(entry, 0, true));
+        BOOST_REQUIRE(!instance.get(entry, 0, false));
+        BOOST_REQUIRE(entry.hash == block0.hash());
+        BOOST_REQUIRE_EQUAL(entry.link, link);
+        BOOST_REQUIRE_EQUAL(entry.bits, header0.bits());
+        BOOST_REQUIRE_EQUAL(entry.timestamp, header0.timestamp());
+        BOOST_REQUIRE_EQUAL(entry.median_time_past, 42u);
+        BOOST_REQUIRE_EQUAL(entry.state, block_state::candidate);
+
+        // State changes are reflected without an index change.
+        BOOST_REQUIRE(instance.validate(link, error::success));
+        BOOST_REQUIRE(instance.promote(link, 0, false));
+        BOOST_REQUIRE(instance.get(entry, 0, true));
+        BOOST_REQUIRE_EQUAL(entry.state, block_state::valid | block_state::confirmed);
+        instance.commit();
+        BOOST_REQUIRE(instance.close());
+    }
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+    BOOST_REQUIRE(instance.open());
+
+    block_database::index_entry entry;
+    BOOST_REQUIRE(instance.get(entry, 0, false));
+    BOOST_REQUIRE(entry.hash == block0.hash());
+    BOOST_REQUIRE_EQUAL(entry.state, block_state::valid | block_state::confirmed);
+    BOOST_REQUIRE(!instance.get(entry, 1, false));
+
+    BOOST_REQUIRE(instance.demote(entry.link, 0, false));
+    BOOST_REQUIRE(!instance.get(entry, 0, false));
+    BOOST_REQUIRE(!instance.get(0, false));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get__index_entry__tracks_neutrino_filter)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const chain::block block0 = settings.genesis_block;
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, true);
+    BOOST_REQUIRE(instance.create());
+
+    const auto link = instance.store(block0.header(), 0, 0);
+    BOOST_REQUIRE(instance.promote(link, 0, true));
+    BOOST_REQUIRE(instance.validate(link, error::success));
+    BOOST_REQUIRE(instance.promote(link, 0, false));
+
+    // The filter is set after the index push.
+    BOOST_REQUIRE(instance.update_neutrino_filter(link, 42));
+
+    block_database::index_entry entry;
+    BOOST_REQUIRE(instance.get(entry, 0, true));
+    BOOST_REQUIRE_EQUAL(entry.neutrino_filter, 42u);
+    BOOST_REQUIRE(instance.get(entry, 0, false));
+    BOOST_REQUIRE_EQUAL(entry.neutrino_filter, instance.get(0, false).neutrino_filter());
+}
+
+BOOST_AUTO_TEST_CASE(block_database__store__header_batch__candidates)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const chain::block block0 = settings.genesis_block;
+
+    auto header1 = block0.header();
+    header1.set_nonce(4);
+    auto header2 = block0.header();
+    header2.set_nonce(110);
+
+    const header_const_ptr_list headers
+    {
+        std::make_shared<const message::header>(block0.header()),
+        std::make_shared<const message::header>(header1),
+        std::make_shared<const message::header>(header2)
+    };
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false);
+    BOOST_REQUIRE(instance.create());
+
+    // The first header exists, so is promoted without being stored again.
+    const auto link0 = instance.store(block0.header(), 0, 0);
+    headers.front()->metadata.exists = true;
+
+    BOOST_REQUIRE(instance.store(headers, 0));
+
+    size_t top;
+    BOOST_REQUIRE(instance.top(top, true));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+    BOOST_REQUIRE(!instance.top(top, false));
+
+    BOOST_REQUIRE_EQUAL(instance.get(0, true).link(), link0);
+    BOOST_REQUIRE(instance.get(1, true).hash() == header1.hash());
+    BOOST_REQUIRE(instance.get(2, true).hash() == header2.hash());
+    BOOST_REQUIRE_EQUAL(instance.get(2, true).height(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.get(2, true).state(), block_state::candidate);
+}
+
 BOOST_AUTO_TEST_CASE(block_database__test)
 {
     // TODO: replace.
@@ -32,8 +32,11 @@ using namespace bc::system::chain;
 #define DIRECTORY "transaction_database"
 #define TRANSACTION1 "0100000001537c9d05b5f7d67b09e5108e3bd5e466909cc9403ddd98bc42973f366fe729410600000000ffffffff0163000000000000001976a914fe06e7b4c88a719e92373de489c08244aee4520b88ac00000000"
 #define TRANSACTION2 "010000000147811c3fc0c0e750af5d0ea7343b16ea2d0c291c002e3db778669216eb689de80000000000ffffffff0118ddf505000000001976a914575c2f0ea88fcbad2389a372d942dea95addc25b88ac00000000"
+#define WITNESS_TRANSACTION "01000000000102fff7f7881a8099afa6940d42d1e7f6362bec38171ea3edf433541db4e4ad969f00000000494830450221008b9d1dc26ba6a9cb62127b02742fa9d754cd3bebf337f7a55d114c8e5cdd30be022040529b194ba3f9281a99f2b1c0a19c0489bc22ede944ccf4ecbab4cc618ef3ed01eeffffffef51e1b804cc89d182d279655c3aa89e815b1b309fe287d9b2b55d57b90ec68a0100000000ffffffff02202cb206000000001976a9148280b37df378db99f66f85c95a783a76ac7a6d5988ac9093510d000000001976a9143bde42dbee7e4dbe6a21b2d50ce2f0167faa815988ac000247304402203609e17b84f6a7d30c80bfa610b5b4542f32a8a0d5447a12fb1366d7f01cc44a0220573a954c4518331561406f90300e8f3358f51928d43c212a8caed02de67eebee0121025476c2e83188368da1ff3e292e7acafcdb3566bb0ad253f62fc70f07aeee635711000000"
 
 static BC_CONSTEXPR auto file_path = DIRECTORY "/tx_table";
+static BC_CONSTEXPR auto witness_path = DIRECTORY "/witness_table";
+static BC_CONSTEXPR auto utxo_path = DIRECTORY "/utxo_table";
 
 struct transaction_database_directory_setup_fixture
 {
@@ -63,7 +66,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__store1__single_transactions__success)
     BOOST_REQUIRE(tx2.from_data(wire_tx2));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -91,6 +96,62 @@ BOOST_AUTO_TEST_CASE(transaction_database__store1__single_transactions__success)
     BOOST_REQUIRE(result3.transaction().hash() == hash2);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__contains__one_stored__expected)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, TRANSACTION1));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1));
+
+    transaction tx2;
+    data_chunk wire_tx2;
+    BOOST_REQUIRE(decode_base16(wire_tx2, TRANSACTION2));
+    BOOST_REQUIRE(tx2.from_data(wire_tx2));
+
+    test::create(file_path);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(instance.create());
+    instance.store(tx1, 100);
+
+    const auto result = instance.contains({ tx2.hash(), tx1.hash() });
+    BOOST_REQUIRE_EQUAL(result.size(), 2u);
+    BOOST_REQUIRE(!result[0]);
+    BOOST_REQUIRE(result[1]);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__to_data__stored__wire_encoding)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, TRANSACTION1));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1));
+
+    transaction tx2;
+    data_chunk wire_tx2;
+    BOOST_REQUIRE(decode_base16(wire_tx2, WITNESS_TRANSACTION));
+    BOOST_REQUIRE(tx2.from_data(wire_tx2, true, true));
+
+    test::create(file_path);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(instance.create());
+    instance.store(tx1, 1);
+    instance.store(tx2, 1);
+
+    const auto result1 = instance.get(tx1.hash());
+    BOOST_REQUIRE(result1);
+    BOOST_REQUIRE(result1.to_data(true) == wire_tx1);
+    BOOST_REQUIRE(result1.to_data(false) == wire_tx1);
+
+    const auto result2 = instance.get(tx2.hash());
+    BOOST_REQUIRE(result2);
+    BOOST_REQUIRE(result2.to_data(true) == wire_tx2);
+    BOOST_REQUIRE(result2.to_data(false) == tx2.to_data(true, false));
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database__store2__list_of_transactions__success)
 {
     transaction tx1;
@@ -104,7 +165,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__store2__list_of_transactions__success
     BOOST_REQUIRE(tx2.from_data(wire_tx2));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -138,7 +201,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__store1__single_unconfirmed__success)
     BOOST_REQUIRE(tx1.from_data(wire_tx1));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -157,6 +222,46 @@ BOOST_AUTO_TEST_CASE(transaction_database__store1__single_unconfirmed__success)
     BOOST_REQUIRE(fetched.transaction().hash() == hash1);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__store1__segregated__witness_round_trips)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, WITNESS_TRANSACTION));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1, true, true));
+    BOOST_REQUIRE(tx1.is_segregated());
+
+    test::create(file_path);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const auto hash1 = tx1.hash();
+    BOOST_REQUIRE(!instance.get(hash1));
+
+    // Setup end
+
+    instance.store(tx1, 1);
+    const auto result1 = instance.get(hash1);
+    BOOST_REQUIRE(result1);
+
+    const auto witnessed = result1.transaction(true);
+    BOOST_REQUIRE(witnessed.is_segregated());
+    BOOST_REQUIRE(witnessed.hash() == hash1);
+    BOOST_REQUIRE(witnessed.hash(true) == tx1.hash(true));
+    BOOST_REQUIRE(witnessed.to_data(true, true) == wire_tx1);
+
+    const auto stripped = result1.transaction(false);
+    BOOST_REQUIRE(!stripped.is_segregated());
+    BOOST_REQUIRE(stripped.hash() == hash1);
+
+    // Inpoints are read without reference to witnesses.
+    auto inpoint = result1.begin();
+    BOOST_REQUIRE(*inpoint++ == tx1.inputs()[0].previous_output());
+    BOOST_REQUIRE(*inpoint++ == tx1.inputs()[1].previous_output());
+    BOOST_REQUIRE(inpoint == result1.end());
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database__store2__list_of_unconfirmed__success)
 {
     transaction tx1;
@@ -170,7 +275,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__store2__list_of_unconfirmed__success)
     BOOST_REQUIRE(tx2.from_data(wire_tx2));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -209,7 +316,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__candidate__with_no_input_in_db__candi
     BOOST_REQUIRE(tx1.from_data(wire_tx1));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -231,7 +340,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__candidate__with_input_in_db__candidat
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     // tx1: coinbase transaction
@@ -291,7 +402,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__uncandidate__with_no_input_in_db__fal
     BOOST_REQUIRE(tx1.from_data(wire_tx1));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -312,7 +425,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__uncandidate__with_input_in_db__candid
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     // tx1: coinbase transaction
@@ -373,7 +488,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__confirm2__single_transaction_not_in_d
     BOOST_REQUIRE(tx1.from_data(wire_tx1));
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const auto hash1 = tx1.hash();
@@ -398,7 +515,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__confirm2__single_transaction_with_inp
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     // tx1: coinbase transaction
@@ -470,7 +589,9 @@ BOOST_AUTO_TEST_CASE(transaction_database_with_cache__confirm2__single_transacti
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 100);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 1000000, 0);
     BOOST_REQUIRE(instance.create());
 
     // tx1: coinbase transaction
@@ -541,7 +662,8 @@ BOOST_AUTO_TEST_CASE(transaction_database_with_cache__confirm1__block_transactio
    uint32_t locktime = 0xffffffff;
 
    test::create(file_path);
-   transaction_database instance(file_path, 1, 1000, 50, 100);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 1000000, 0);
    BOOST_REQUIRE(instance.create());
 
    // tx1: coinbase transaction
@@ -646,7 +768,8 @@ BOOST_AUTO_TEST_CASE(transaction_database__unconfirm__confirmed_block_with_confi
    uint32_t locktime = 0xffffffff;
 
    test::create(file_path);
-   transaction_database instance(file_path, 1, 1000, 50, 0);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
    BOOST_REQUIRE(instance.create());
 
    // tx1: coinbase transaction
@@ -718,7 +841,8 @@ BOOST_AUTO_TEST_CASE(transaction_database__unconfirm__spent_across_blocks__succe
    uint32_t locktime = 0xffffffff;
 
    test::create(file_path);
-   transaction_database instance(file_path, 1, 1000, 50, 0);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
    BOOST_REQUIRE(instance.create());
 
    // tx1: coinbase transaction
@@ -794,13 +918,153 @@ BOOST_AUTO_TEST_CASE(transaction_database__unconfirm__spent_across_blocks__succe
    BOOST_REQUIRE_EQUAL(metadata.confirmed_spent_height, output::validation::not_spent);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__unconfirm__link_spent_in_prior_block__success)
+{
+   uint32_t version = 2345u;
+   uint32_t locktime = 0xffffffff;
+
+   test::create(file_path);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+   BOOST_REQUIRE(instance.create());
+
+   const chain::input::list tx1_inputs
+   {
+       { chain::point{ null_hash, chain::point::null_index }, {}, 0 }
+   };
+
+   const chain::output::list tx1_outputs
+   {
+       { 1200, {} }
+   };
+
+   chain::transaction tx1(version, locktime, tx1_inputs, tx1_outputs);
+   const auto hash1 = tx1.hash();
+   instance.store(tx1, 1);
+
+   const chain::input::list tx2_inputs
+   {
+       { { hash1, 0 }, {}, 0 }
+   };
+
+   const chain::output::list tx2_outputs
+   {
+       { 1200, {} }
+   };
+
+   const chain::transaction tx2(version, locktime, tx2_inputs, tx2_outputs);
+   const auto hash2 = tx2.hash();
+   instance.store(tx2, 1);
+
+   const auto link2 = instance.get(hash2).link();
+   instance.confirm(instance.get(hash1).link(), 23, 56, 1);
+   instance.confirm(link2, 123, 156, 1);
+
+   // Setup end
+
+   BOOST_REQUIRE(instance.unconfirm(link2));
+
+   const auto tx2_reloaded = instance.get(hash2);
+   BOOST_REQUIRE_EQUAL(tx2_reloaded.height(), machine::rule_fork::unverified);
+   BOOST_REQUIRE_EQUAL(tx2_reloaded.median_time_past(), 0u);
+   BOOST_REQUIRE_EQUAL(tx2_reloaded.position(), transaction_result::deconfirmed);
+   BOOST_REQUIRE(!tx2_reloaded.transaction().metadata.confirmed);
+
+   const auto tx1_reloaded = instance.get(hash1);
+   BOOST_REQUIRE_EQUAL(tx1_reloaded.height(), 23);
+   BOOST_REQUIRE_EQUAL(tx1_reloaded.position(), 1);
+
+   const auto metadata = tx1_reloaded.transaction().outputs().front().metadata;
+   BOOST_REQUIRE_EQUAL(metadata.confirmed_spent_height, output::validation::not_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__prune__fully_spent_at_height__pruned)
+{
+   uint32_t version = 2345u;
+   uint32_t locktime = 0xffffffff;
+
+   test::create(file_path);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+   BOOST_REQUIRE(instance.create());
+
+   const chain::input::list tx1_inputs
+   {
+       { chain::point{ null_hash, chain::point::null_index }, {}, 0 }
+   };
+
+   const chain::output::list tx1_outputs
+   {
+       { 1200, {} }
+   };
+
+   chain::transaction tx1(version, locktime, tx1_inputs, tx1_outputs);
+   const auto hash1 = tx1.hash();
+   instance.store(tx1, 1);
+
+   const chain::input::list tx2_inputs
+   {
+       { { hash1, 0 }, {}, 0 }
+   };
+
+   const chain::output::list tx2_outputs
+   {
+       { 1200, {} }
+   };
+
+   const chain::transaction tx2(version, locktime, tx2_inputs, tx2_outputs);
+   const auto hash2 = tx2.hash();
+   instance.store(tx2, 1);
+
+   const auto link1 = instance.get(hash1).link();
+   const auto link2 = instance.get(hash2).link();
+   instance.confirm(link1, 23, 56, 1);
+   instance.confirm(link2, 123, 156, 1);
+
+   // Setup end
+
+   // Spent above the prune height, or unspent, is retained.
+   BOOST_REQUIRE(instance.prune(link1, 122));
+   BOOST_REQUIRE(!instance.get(hash1).pruned());
+   BOOST_REQUIRE(instance.prune(link2, 200));
+   BOOST_REQUIRE(!instance.get(hash2).pruned());
+
+   BOOST_REQUIRE(instance.prune(link1, 123));
+   BOOST_REQUIRE(instance.reclaim());
+
+   const auto tx1_pruned = instance.get(hash1);
+   BOOST_REQUIRE(tx1_pruned);
+   BOOST_REQUIRE(tx1_pruned.pruned());
+   BOOST_REQUIRE_EQUAL(tx1_pruned.height(), 23u);
+   BOOST_REQUIRE_EQUAL(tx1_pruned.position(), 1u);
+   BOOST_REQUIRE(tx1_pruned.is_candidate_spent(200));
+   BOOST_REQUIRE(!tx1_pruned.output(0).is_valid());
+   BOOST_REQUIRE(!tx1_pruned.transaction().is_valid());
+   BOOST_REQUIRE(tx1_pruned.begin() == tx1_pruned.end());
+
+   data_chunk wire;
+   data_sink ostream(wire);
+   ostream_writer sink(ostream);
+   BOOST_REQUIRE(!tx1_pruned.to_data(sink, true));
+   BOOST_REQUIRE(tx1_pruned.to_data(true).empty());
+
+   const chain::output_point point{ hash1, 0 };
+   BOOST_REQUIRE(!instance.get_output(point, 200));
+
+   // The spender is unaffected.
+   const auto tx2_reloaded = instance.get(hash2);
+   BOOST_REQUIRE(!tx2_reloaded.pruned());
+   BOOST_REQUIRE(tx2_reloaded.transaction().hash() == hash2);
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database_with_cache__unconfirm__single_confirmed__success)
 {
    uint32_t version = 2345u;
    uint32_t locktime = 0xffffffff;
 
    test::create(file_path);
-   transaction_database instance(file_path, 1, 1000, 50, 100);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 1000000, 0);
    BOOST_REQUIRE(instance.create());
 
    // tx1: coinbase transaction
@@ -877,7 +1141,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_block_metadata__nonexisting__not_
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx(version, locktime, {}, {});
@@ -900,7 +1166,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_block_metadata__no_bip34_and_cand
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -930,7 +1198,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_block_metadata__not_yet_confirmed
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -955,7 +1225,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_block_metadata__confirmed__unveri
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -984,7 +1256,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_pool_metadata__nonexisting__not_f
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx(version, locktime, {}, {});
@@ -1006,7 +1280,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_pool_metadata__confirmed__unverif
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -1032,7 +1308,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_pool_metadata__confirmed__unverif
 BOOST_AUTO_TEST_CASE(transaction_database__get_output__null_point__false)
 {
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     // setup end
@@ -1046,7 +1324,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__not_found__false)
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1(version, locktime, {}, {});
@@ -1063,7 +1343,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__genesis__false)
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1(version, locktime, {}, {});
@@ -1080,7 +1362,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__no_output_at_index__false
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -1096,7 +1380,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__unconfirmed_at_fork_heigh
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -1120,7 +1406,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__deconfirmed_not_spent___u
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
@@ -1151,7 +1439,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__confirmed_at_height__conf
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1201, {} } } };
@@ -1181,7 +1471,8 @@ BOOST_AUTO_TEST_CASE(transaction_database_with_cache__get_output__confirmed_at_h
    uint32_t locktime = 0xffffffff;
 
    test::create(file_path);
-   transaction_database instance(file_path, 1, 1000, 50, 100);
+   test::create(witness_path);
+   transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 1000000, 0);
    BOOST_REQUIRE(instance.create());
 
    const transaction tx1{ locktime, version, {}, { { 1201, {} } } };
@@ -1205,13 +1496,41 @@ BOOST_AUTO_TEST_CASE(transaction_database_with_cache__get_output__confirmed_at_h
    BOOST_REQUIRE(!point.metadata.confirmed_spent);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__get_outputs__two_points_one_missing__expected)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    instance.store({ tx1 });
+
+    const output_point point0{ tx1.hash(), 0 };
+    const output_point point1{ tx1.hash(), 1 };
+    const output_point point2{ tx1.hash(), 2 };
+    instance.get_outputs({ &point0, &point1, &point2 }, 123);
+
+    BOOST_REQUIRE_EQUAL(point0.metadata.cache.value(), 1201u);
+    BOOST_REQUIRE_EQUAL(point1.metadata.cache.value(), 1202u);
+    BOOST_REQUIRE(!point0.metadata.confirmed);
+    BOOST_REQUIRE(!point1.metadata.confirmed);
+    BOOST_REQUIRE(!point2.metadata.cache.is_valid());
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database__get_output__unconfirmed_at_height__unconfirmed)
 {
     uint32_t version = 2345u;
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     // tx1 is not confirmed as it is at coinbase position, so we test
@@ -1244,7 +1563,9 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__prevout_spent__spent)
     uint32_t locktime = 0xffffffff;
 
     test::create(file_path);
-    transaction_database instance(file_path, 1, 1000, 50, 0);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database instance(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
     BOOST_REQUIRE(instance.create());
 
     const transaction tx1{ locktime, version, {}, { { 1201, {} } } };
@@ -1283,4 +1604,61 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__prevout_spent__spent)
     BOOST_REQUIRE(point.metadata.confirmed_spent);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__relocate__stored__copied_once)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, WITNESS_TRANSACTION));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1, true, true));
+    const transaction tx2{ 0xffffffff, 2345u, {}, { { 1201, {} } } };
+
+    test::create(file_path);
+    test::create(witness_path);
+    test::create(utxo_path);
+    transaction_database source(file_path, witness_path, utxo_path, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(source.create());
+
+    const auto file_path2 = DIRECTORY "/tx_table2";
+    const auto witness_path2 = DIRECTORY "/witness_table2";
+    const auto utxo_path2 = DIRECTORY "/utxo_table2";
+    test::create(file_path2);
+    test::create(witness_path2);
+    test::create(utxo_path2);
+    transaction_database instance(file_path2, witness_path2, utxo_path2, 1, 1, 1, 1000, 1000, 50, 0, 0);
+    BOOST_REQUIRE(instance.create());
+
+    BOOST_REQUIRE(source.store(tx2, 7));
+    BOOST_REQUIRE(source.store(tx1, 9));
+    const auto link1 = source.get(tx1.hash()).link();
+    const auto link2 = source.get(tx2.hash()).link();
+
+    // Setup end
+
+    file_offset relocated1;
+    BOOST_REQUIRE(instance.relocate(relocated1, source, link1));
+    BOOST_REQUIRE_EQUAL(relocated1, instance.get(tx1.hash()).link());
+
+    file_offset relocated2;
+    BOOST_REQUIRE(instance.relocate(relocated2, source, link2));
+    BOOST_REQUIRE_EQUAL(relocated2, instance.get(tx2.hash()).link());
+
+    // Copies are in relocation order, not source order.
+    BOOST_REQUIRE_LT(relocated1, relocated2);
+
+    // A relocated tx is not copied again.
+    file_offset relocated3;
+    BOOST_REQUIRE(instance.relocate(relocated3, source, link1));
+    BOOST_REQUIRE_EQUAL(relocated3, relocated1);
+
+    const auto result1 = instance.get(relocated1);
+    BOOST_REQUIRE(result1);
+    BOOST_REQUIRE_EQUAL(result1.height(), 9u);
+    BOOST_REQUIRE(result1.transaction(true).to_data(true, true) == wire_tx1);
+
+    const auto result2 = instance.get(relocated2);
+    BOOST_REQUIRE(result2);
+    BOOST_REQUIRE_EQUAL(result2.height(), 7u);
+    BOOST_REQUIRE(result2.transaction() == tx2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+#define DIRECTORY "utxo_database"
+
+static BC_CONSTEXPR auto file_path = DIRECTORY "/utxo_table";
+
+struct utxo_database_directory_setup_fixture
+{
+    utxo_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+
+    ~utxo_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+static const output_point point1{ hash_literal("0000000000000000000000000000000000000000000000000000000000000001"), 0 };
+static const output_point point2{ hash_literal("0000000000000000000000000000000000000000000000000000000000000001"), 1 };
+
+static output make_output()
+{
+    return output{ 42, script::to_pay_key_hash_pattern(null_short_hash) };
+}
+
+BOOST_FIXTURE_TEST_SUITE(utxo_database_tests, utxo_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(utxo_database__populate__empty__false)
+{
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(!instance.populate(point1, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__store__populate__expected)
+{
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto expected = make_output();
+    BOOST_REQUIRE(instance.store(point1, expected, 100, 42, true));
+    BOOST_REQUIRE(instance.populate(point1, max_size_t));
+    BOOST_REQUIRE(!instance.populate(point2, max_size_t));
+
+    const auto& prevout = point1.metadata;
+    BOOST_REQUIRE(prevout.cache == expected);
+    BOOST_REQUIRE_EQUAL(prevout.height, 100u);
+    BOOST_REQUIRE_EQUAL(prevout.median_time_past, 42u);
+    BOOST_REQUIRE(prevout.coinbase);
+    BOOST_REQUIRE(prevout.confirmed);
+    BOOST_REQUIRE(!prevout.candidate_spent);
+    BOOST_REQUIRE(!prevout.confirmed_spent);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__populate__above_fork_height__unconfirmed)
+{
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store(point1, make_output(), 100, 42, false));
+    BOOST_REQUIRE(instance.populate(point1, 99));
+    BOOST_REQUIRE(!point1.metadata.confirmed);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__remove__stored__not_found)
+{
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store(point1, make_output(), 100, 42, false));
+    BOOST_REQUIRE(instance.store(point2, make_output(), 100, 42, false));
+    BOOST_REQUIRE(instance.remove(point1));
+    BOOST_REQUIRE(!instance.remove(point1));
+    BOOST_REQUIRE(!instance.populate(point1, max_size_t));
+    BOOST_REQUIRE(instance.populate(point2, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__candidate__stored__candidate_spent)
+{
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(!instance.candidate(point1, true));
+    BOOST_REQUIRE(instance.store(point1, make_output(), 100, 42, false));
+    BOOST_REQUIRE(instance.candidate(point1, true));
+    BOOST_REQUIRE(instance.populate(point1, max_size_t));
+    BOOST_REQUIRE(point1.metadata.candidate_spent);
+    BOOST_REQUIRE(instance.candidate(point1, false));
+    BOOST_REQUIRE(instance.populate(point1, max_size_t));
+    BOOST_REQUIRE(!point1.metadata.candidate_spent);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <string>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+// Test directory
+#define DIRECTORY "journal"
+
+static const std::string data_name = "data";
+
+static void write_file(const std::string& file, const std::string& content)
+{
+    ofstream stream(file, std::ios::binary);
+    stream.write(content.data(), content.size());
+}
+
+static std::string read_file(const std::string& file)
+{
+    ifstream stream(file, std::ios::binary);
+    return { std::istreambuf_iterator<char>(stream),
+        std::istreambuf_iterator<char>() };
+}
+
+static void write_log(const std::string& file, const std::string& boot,
+    file_offset position, const std::string& value)
+{
+    ofstream stream(file, std::ios::binary);
+    ostream_writer sink(stream);
+    sink.write_byte(0);
+    sink.write_string(boot);
+    sink.write_string(data_name);
+    sink.write_8_bytes_little_endian(position);
+    sink.write_4_bytes_little_endian(value.size());
+    sink.write_string(value, value.size());
+}
+
+static void record(journal& log, const std::string& file, file_offset position,
+    const std::string& value)
+{
+    log.record(file, position, reinterpret_cast<const uint8_t*>(value.data()),
+        value.size());
+}
+
+struct journal_directory_setup_fixture
+{
+    journal_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(journal_tests, journal_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(journal__rollback__missing_file__false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(!journal::rollback(file));
+}
+
+BOOST_AUTO_TEST_CASE(journal__rollback__interrupted_write__restores_oldest_values)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "abcdef");
+
+    journal instance(file, true);
+    BOOST_REQUIRE(instance.open());
+    instance.begin();
+    record(instance, data, 1, "bc");
+    write_file(data, "aXYdef");
+    record(instance, data, 1, "XY");
+    record(instance, data, 4, "ef");
+    write_file(data, "aZZdZZ");
+    BOOST_REQUIRE(instance.close());
+
+    BOOST_REQUIRE(journal::rollback(file));
+    BOOST_REQUIRE_EQUAL(read_file(data), "abcdef");
+    BOOST_REQUIRE(read_file(file).empty());
+}
+
+BOOST_AUTO_TEST_CASE(journal__rollback__truncated_entry__ignored)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "abcdef");
+
+    journal instance(file, true);
+    BOOST_REQUIRE(instance.open());
+    instance.begin();
+    record(instance, data, 0, "ab");
+    record(instance, data, 2, "cd");
+    write_file(data, "ZZZZef");
+    BOOST_REQUIRE(instance.close());
+
+    // Drop the last byte of the second entry.
+    const auto log = read_file(file);
+    write_file(file, log.substr(0, log.size() - 1));
+
+    BOOST_REQUIRE(journal::rollback(file));
+    BOOST_REQUIRE_EQUAL(read_file(data), "abZZef");
+}
+
+BOOST_AUTO_TEST_CASE(journal__rollback__unsynchronized_same_boot__restores)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "abcdef");
+
+    journal instance(file, false);
+    BOOST_REQUIRE(instance.open());
+    instance.begin();
+    record(instance, data, 1, "bc");
+    write_file(data, "aXYdef");
+    BOOST_REQUIRE(instance.close());
+
+    // Requires a boot identifier from the platform.
+    BOOST_REQUIRE_EQUAL(journal::rollback(file),
+        !journal::boot_identity().empty());
+    BOOST_REQUIRE_EQUAL(read_file(data),
+        journal::boot_identity().empty() ? "aXYdef" : "abcdef");
+}
+
+BOOST_AUTO_TEST_CASE(journal__rollback__unsynchronized_other_boot__false_unchanged)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "aXYdef");
+    write_log(file, "another boot", 1, "bc");
+
+    BOOST_REQUIRE(!journal::rollback(file));
+    BOOST_REQUIRE_EQUAL(read_file(data), "aXYdef");
+}
+
+BOOST_AUTO_TEST_CASE(journal__rollback__synchronized_other_boot__restores)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "aXYdef");
+    write_log(file, "another boot", 1, "bc");
+
+    // Mark the log synchronized.
+    auto log = read_file(file);
+    log[0] = 1;
+    write_file(file, log);
+
+    BOOST_REQUIRE(journal::rollback(file));
+    BOOST_REQUIRE_EQUAL(read_file(data), "abcdef");
+}
+
+BOOST_AUTO_TEST_CASE(journal__end__overlapping_writes__clears_after_last)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "abcdef");
+
+    journal instance(file, true);
+    BOOST_REQUIRE(instance.open());
+    const auto header = read_file(file).size();
+    instance.begin();
+    instance.begin();
+    record(instance, data, 0, "ab");
+    BOOST_REQUIRE(instance.end());
+    BOOST_REQUIRE_GT(read_file(file).size(), header);
+    BOOST_REQUIRE(instance.end());
+
+    // Only the header remains.
+    BOOST_REQUIRE_EQUAL(read_file(file).size(), header);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(journal__end__unbalanced__true)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    journal instance(file, true);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.end());
+}
+
+BOOST_AUTO_TEST_CASE(journal__record__not_open__false_end_false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    static const std::string value = "ab";
+
+    journal instance(file, true);
+    instance.begin();
+    BOOST_REQUIRE(!instance.record(data, 0,
+        reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+    BOOST_REQUIRE(!instance.end());
+}
+
+BOOST_AUTO_TEST_CASE(journal__flush__recorded_entry__true_retained_until_end)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string data = DIRECTORY "/" + data_name;
+    write_file(data, "abcdef");
+
+    journal instance(file, true);
+    BOOST_REQUIRE(instance.open());
+    const auto header = read_file(file).size();
+    instance.begin();
+    record(instance, data, 0, "ab");
+    BOOST_REQUIRE(instance.flush());
+    BOOST_REQUIRE(instance.flush());
+    BOOST_REQUIRE_GT(read_file(file).size(), header);
+    BOOST_REQUIRE(instance.end());
+    BOOST_REQUIRE_EQUAL(read_file(file).size(), header);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
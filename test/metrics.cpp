@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/database.hpp>
+
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(metrics_tests)
+
+typedef metrics::duration duration;
+
+static const metrics::operation_metrics& find(const metrics::report& report,
+    metrics::operation operation)
+{
+    return report.operations[operation];
+}
+
+BOOST_AUTO_TEST_CASE(metrics__snapshot__default__all_operations_empty)
+{
+    const metrics instance;
+    const auto report = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(report.operations.size(), metrics::operations);
+
+    for (const auto& operation: report.operations)
+    {
+        BOOST_REQUIRE_EQUAL(operation.units, 0u);
+        BOOST_REQUIRE_EQUAL(operation.latency.count, 0u);
+        BOOST_REQUIRE_EQUAL(operation.latency.maximum.count(), 0);
+        BOOST_REQUIRE_EQUAL(operation.lock_wait.count, 0u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(metrics__to_string__operations__expected)
+{
+    BOOST_REQUIRE_EQUAL(metrics::to_string(metrics::push), "push");
+    BOOST_REQUIRE_EQUAL(metrics::to_string(metrics::store), "store");
+    BOOST_REQUIRE_EQUAL(metrics::to_string(metrics::flush), "flush");
+    BOOST_REQUIRE_EQUAL(metrics::to_string(metrics::reorganize_blocks),
+        "reorganize_blocks");
+}
+
+BOOST_AUTO_TEST_CASE(metrics__record__small_values__exact_percentiles)
+{
+    metrics instance;
+
+    for (auto value = 1; value <= 10; ++value)
+        instance.record(metrics::store, duration(value));
+
+    const auto& store = find(instance.snapshot(), metrics::store);
+    BOOST_REQUIRE_EQUAL(store.name, "store");
+    BOOST_REQUIRE_EQUAL(store.units, 10u);
+    BOOST_REQUIRE_EQUAL(store.latency.count, 10u);
+    BOOST_REQUIRE_EQUAL(store.latency.total.count(), 55);
+    BOOST_REQUIRE_EQUAL(store.latency.maximum.count(), 10);
+    BOOST_REQUIRE_EQUAL(store.latency.p50.count(), 5);
+    BOOST_REQUIRE_EQUAL(store.latency.p90.count(), 9);
+    BOOST_REQUIRE_EQUAL(store.latency.p99.count(), 10);
+    BOOST_REQUIRE_EQUAL(store.latency.p999.count(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(metrics__record__large_values__bounded_relative_error)
+{
+    metrics instance;
+    const int64_t small = 1000000;
+    const int64_t large = 2000000;
+
+    for (auto count = 0; count < 99; ++count)
+        instance.record(metrics::push, duration(small));
+
+    instance.record(metrics::push, duration(large), 42);
+
+    const auto& push = find(instance.snapshot(), metrics::push);
+    BOOST_REQUIRE_EQUAL(push.units, 99u + 42u);
+    BOOST_REQUIRE_EQUAL(push.latency.count, 100u);
+    BOOST_REQUIRE_EQUAL(push.latency.maximum.count(), large);
+    BOOST_REQUIRE_GE(push.latency.p50.count(), small);
+    BOOST_REQUIRE_LT(push.latency.p50.count(), small + small / 32);
+    BOOST_REQUIRE_EQUAL(push.latency.p99.count(), push.latency.p50.count());
+    BOOST_REQUIRE_EQUAL(push.latency.p999.count(), large);
+}
+
+BOOST_AUTO_TEST_CASE(metrics__record__beyond_range__maximum_preserved)
+{
+    metrics instance;
+    const int64_t huge = int64_t(1) << 40;
+    instance.record(metrics::flush, duration(huge));
+
+    const auto& flush = find(instance.snapshot(), metrics::flush);
+    BOOST_REQUIRE_EQUAL(flush.latency.count, 1u);
+    BOOST_REQUIRE_EQUAL(flush.latency.maximum.count(), huge);
+    BOOST_REQUIRE_EQUAL(flush.latency.p50.count(), huge);
+}
+
+BOOST_AUTO_TEST_CASE(metrics__record_wait__lock_wait_only)
+{
+    metrics instance;
+    instance.record_wait(metrics::candidate, duration(7));
+
+    const auto& candidate = find(instance.snapshot(), metrics::candidate);
+    BOOST_REQUIRE_EQUAL(candidate.units, 0u);
+    BOOST_REQUIRE_EQUAL(candidate.latency.count, 0u);
+    BOOST_REQUIRE_EQUAL(candidate.lock_wait.count, 1u);
+    BOOST_REQUIRE_EQUAL(candidate.lock_wait.maximum.count(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(metrics__timer__locked__latency_and_lock_wait)
+{
+    metrics instance;
+
+    {
+        metrics::timer timer(instance, metrics::confirm, 3);
+        timer.locked();
+        timer.set_units(5);
+    }
+
+    const auto& confirm = find(instance.snapshot(), metrics::confirm);
+    BOOST_REQUIRE_EQUAL(confirm.units, 5u);
+    BOOST_REQUIRE_EQUAL(confirm.latency.count, 1u);
+    BOOST_REQUIRE_EQUAL(confirm.lock_wait.count, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(metrics__timer__not_locked__no_lock_wait)
+{
+    metrics instance;
+
+    {
+        const metrics::timer timer(instance, metrics::read);
+    }
+
+    const auto& read = find(instance.snapshot(), metrics::read);
+    BOOST_REQUIRE_EQUAL(read.units, 1u);
+    BOOST_REQUIRE_EQUAL(read.latency.count, 1u);
+    BOOST_REQUIRE_EQUAL(read.lock_wait.count, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -78,6 +78,44 @@ BOOST_AUTO_TEST_CASE(hash_table__slab__one_element__round_trips)
     table.commit();
 }
 
+BOOST_AUTO_TEST_CASE(hash_table__slab__contains__expected)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint32_t link_type;
+    typedef hash_table<slab_manager<link_type>, index_type, link_type, key_type> slab_map;
+
+    // Create the file and initialize hash table (few buckets for collisions).
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    slab_map table(file, 2u);
+    BOOST_REQUIRE(table.create());
+
+    const key_type key1{ { 0xde, 0xad, 0xbe, 0xef } };
+    const key_type key2{ { 0xba, 0xad, 0xbe, 0xef } };
+    const key_type key3{ { 0xba, 0xad, 0xf0, 0x0d } };
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_byte(42);
+    };
+
+    auto element = table.allocator();
+    element.create(key1, writer, 1);
+    table.link(element);
+    element.create(key3, writer, 1);
+    table.link(element);
+
+    const auto result = table.contains({ key3, key2, key1, key2 });
+    BOOST_REQUIRE_EQUAL(result.size(), 4u);
+    BOOST_REQUIRE(result[0]);
+    BOOST_REQUIRE(!result[1]);
+    BOOST_REQUIRE(result[2]);
+    BOOST_REQUIRE(!result[3]);
+    BOOST_REQUIRE(table.contains({}).empty());
+}
+
 BOOST_AUTO_TEST_CASE(hash_table__slab__multiple_elements__expected)
 {
     // Define hash table type.
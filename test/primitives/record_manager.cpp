@@ -88,6 +88,28 @@ BOOST_AUTO_TEST_CASE(record_manager__allocate__two_records__expected)
     BOOST_REQUIRE_GE(file.capacity(), link_size + 2 * record_size);
 }
 
+BOOST_AUTO_TEST_CASE(record_manager__reserve__two_records__capacity_without_count)
+{
+    typedef uint64_t link_type;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto record_size = 10u;
+    const auto link_size = sizeof(link_type);
+    record_manager<link_type> manager(file, 0, record_size);
+    BOOST_REQUIRE(manager.create());
+
+    BOOST_REQUIRE(manager.reserve(2));
+    BOOST_REQUIRE_EQUAL(manager.count(), 0u);
+    BOOST_REQUIRE_EQUAL(file.logical(), link_size);
+
+    const auto link1 = manager.allocate(2);
+    BOOST_REQUIRE_EQUAL(link1, 0u);
+    BOOST_REQUIRE_EQUAL(manager.count(), 2u);
+    BOOST_REQUIRE_GE(file.capacity(), link_size + 2 * record_size);
+}
+
 BOOST_AUTO_TEST_CASE(record_manager__count__multiple_records_with_offset__expected)
 {
     typedef uint64_t link_type;
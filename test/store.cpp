@@ -76,6 +76,8 @@ BOOST_AUTO_TEST_CASE(store__construct__no_indexes__expected_files)
     static const std::string confirmed_index = directory + "/" + store::CONFIRMED_INDEX;
     static const std::string tx_index = directory + "/" + store::TRANSACTION_INDEX;
     static const std::string tx_table = directory + "/" + store::TRANSACTION_TABLE;
+    static const std::string witness_table = directory + "/" + store::WITNESS_TABLE;
+    static const std::string utxo_table = directory + "/" + store::UTXO_TABLE;
     static const std::string payment_table = directory + "/" + store::PAYMENT_TABLE;
     static const std::string payment_rows = directory + "/" + store::PAYMENT_ROWS;
 
@@ -84,6 +86,8 @@ BOOST_AUTO_TEST_CASE(store__construct__no_indexes__expected_files)
     BOOST_REQUIRE(!test::exists(confirmed_index));
     BOOST_REQUIRE(!test::exists(tx_index));
     BOOST_REQUIRE(!test::exists(tx_table));
+    BOOST_REQUIRE(!test::exists(witness_table));
+    BOOST_REQUIRE(!test::exists(utxo_table));
     BOOST_REQUIRE(!test::exists(payment_table));
     BOOST_REQUIRE(!test::exists(payment_rows));
 
@@ -94,6 +98,8 @@ BOOST_AUTO_TEST_CASE(store__construct__no_indexes__expected_files)
     BOOST_REQUIRE(test::exists(confirmed_index));
     BOOST_REQUIRE(test::exists(tx_index));
     BOOST_REQUIRE(test::exists(tx_table));
+    BOOST_REQUIRE(test::exists(witness_table));
+    BOOST_REQUIRE(test::exists(utxo_table));
     BOOST_REQUIRE(!test::exists(payment_table));
     BOOST_REQUIRE(!test::exists(payment_rows));
 
@@ -110,6 +116,8 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     static const std::string confirmed_index = directory + "/" + store::CONFIRMED_INDEX;
     static const std::string tx_index = directory + "/" + store::TRANSACTION_INDEX;
     static const std::string tx_table = directory + "/" + store::TRANSACTION_TABLE;
+    static const std::string witness_table = directory + "/" + store::WITNESS_TABLE;
+    static const std::string utxo_table = directory + "/" + store::UTXO_TABLE;
     static const std::string payment_table = directory + "/" + store::PAYMENT_TABLE;
     static const std::string payment_rows = directory + "/" + store::PAYMENT_ROWS;
 
@@ -118,6 +126,8 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     BOOST_REQUIRE(!test::exists(confirmed_index));
     BOOST_REQUIRE(!test::exists(tx_index));
     BOOST_REQUIRE(!test::exists(tx_table));
+    BOOST_REQUIRE(!test::exists(witness_table));
+    BOOST_REQUIRE(!test::exists(utxo_table));
     BOOST_REQUIRE(!test::exists(payment_table));
     BOOST_REQUIRE(!test::exists(payment_rows));
 
@@ -128,6 +138,8 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     BOOST_REQUIRE(test::exists(confirmed_index));
     BOOST_REQUIRE(test::exists(tx_index));
     BOOST_REQUIRE(test::exists(tx_table));
+    BOOST_REQUIRE(test::exists(witness_table));
+    BOOST_REQUIRE(test::exists(utxo_table));
     BOOST_REQUIRE(test::exists(payment_table));
     BOOST_REQUIRE(test::exists(payment_rows));
 
@@ -213,6 +225,87 @@ BOOST_AUTO_TEST_CASE(store__construct__unbalanced_begin_write__leaves_lock_after
     BOOST_REQUIRE(test::exists(flush_lock));
 }
 
+BOOST_AUTO_TEST_CASE(store__open__interrupted_write__recovers_from_journal)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+    static const std::string journal = directory + "/" + store::JOURNAL;
+
+    store_accessor interrupted(directory, false, false, true);
+    BOOST_REQUIRE(interrupted.create());
+    BOOST_REQUIRE(interrupted.open());
+    BOOST_REQUIRE(test::exists(journal));
+    BOOST_REQUIRE(interrupted.begin_write());
+    BOOST_REQUIRE(interrupted.close());
+    BOOST_REQUIRE(test::exists(flush_lock));
+
+    store_accessor instance(directory, false, false, true);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(store__open__flush_lock_without_journal__failure)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    static const std::string journal = directory + "/" + store::JOURNAL;
+
+    store_accessor interrupted(directory, false, false, true);
+    BOOST_REQUIRE(interrupted.create());
+    BOOST_REQUIRE(interrupted.open());
+    BOOST_REQUIRE(interrupted.begin_write());
+    BOOST_REQUIRE(interrupted.close());
+    BOOST_REQUIRE(test::remove(journal));
+
+    store_accessor instance(directory, false, false, true);
+    BOOST_REQUIRE(!instance.open());
+}
+
+BOOST_AUTO_TEST_CASE(store__open__interrupted_session_without_flush__recovers_from_journal)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+
+    store_accessor interrupted(directory);
+    BOOST_REQUIRE(interrupted.create());
+    BOOST_REQUIRE(interrupted.open());
+    BOOST_REQUIRE(interrupted.close());
+
+    // Simulate termination of the process within the session.
+    BOOST_REQUIRE(test::create(flush_lock));
+
+    // The unsynchronized journal was written within this system boot.
+    store_accessor instance(directory);
+    BOOST_REQUIRE_EQUAL(instance.open(), !journal::boot_identity().empty());
+    BOOST_REQUIRE(instance.close());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+}
+
+BOOST_AUTO_TEST_CASE(store__open__interrupted_session_without_flush_other_boot__failure)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+    static const std::string journal = directory + "/" + store::JOURNAL;
+
+    store_accessor interrupted(directory);
+    BOOST_REQUIRE(interrupted.create());
+    BOOST_REQUIRE(interrupted.open());
+    BOOST_REQUIRE(interrupted.close());
+    BOOST_REQUIRE(test::create(flush_lock));
+
+    // Write an unsynchronized journal header from another system boot.
+    {
+        ofstream stream(journal, std::ios::binary);
+        ostream_writer sink(stream);
+        sink.write_byte(0);
+        sink.write_string("another boot");
+    }
+
+    store_accessor instance(directory);
+    BOOST_REQUIRE(!instance.open());
+    BOOST_REQUIRE(test::exists(flush_lock));
+}
+
 BOOST_AUTO_TEST_CASE(store__construct__failed_flush__expected)
 {
     static const std::string directory = DIRECTORY "/" + TEST_NAME;
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+BOOST_AUTO_TEST_SUITE(transaction_cache_tests)
+
+// Capacity is divided over 16 shards.
+static const auto shards = 16u;
+static const transaction empty_tx{ 0, 0, {}, {} };
+static const auto empty_tx_size = empty_tx.serialized_size(true, true);
+
+BOOST_AUTO_TEST_CASE(transaction_cache__construct__capacity_0__disabled)
+{
+    const transaction_cache cache(0);
+    BOOST_REQUIRE(cache.disabled());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__construct__capacity_42__not_disabled)
+{
+    const transaction_cache cache(42);
+    BOOST_REQUIRE(!cache.disabled());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__construct__capacity_42__empty)
+{
+    const transaction_cache cache(42);
+    BOOST_REQUIRE(cache.empty());
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__hit_rate__default__1)
+{
+    const transaction_cache cache(0);
+    BOOST_REQUIRE_EQUAL(cache.hit_rate(), 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__capacity_0__empty)
+{
+    transaction_cache cache(0);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__exceeds_shard_capacity__empty)
+{
+    transaction_cache cache(shards * empty_tx_size - 1u);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__one__size_1)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__same_link_twice__size_1)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__remove__only__empty)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    cache.remove(42);
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__remove__missing__unchanged)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    cache.remove(43);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__removed_since_epoch__empty)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    const auto epoch = cache.epoch(42);
+    cache.remove(42);
+    cache.add(42, empty_tx, epoch);
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__current_epoch__size_1)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.remove(42);
+    cache.add(42, empty_tx, cache.epoch(42));
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__clear__two__empty)
+{
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    cache.add(43, empty_tx);
+    cache.clear();
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__populate__missing__false)
+{
+    transaction out_tx;
+    const transaction_cache cache(shards * empty_tx_size);
+    BOOST_REQUIRE(!cache.populate(out_tx, 42, true));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__populate__present__expected)
+{
+    transaction out_tx;
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE(cache.populate(out_tx, 42, true));
+    BOOST_REQUIRE(out_tx == empty_tx);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__populate__not_segregated_without_witness__expected)
+{
+    transaction out_tx;
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE(cache.populate(out_tx, 42, false));
+    BOOST_REQUIRE(out_tx == empty_tx);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__populate__hit_and_miss__hit_rate_two_thirds)
+{
+    transaction out_tx;
+    transaction_cache cache(shards * empty_tx_size);
+    cache.add(42, empty_tx);
+    BOOST_REQUIRE(cache.populate(out_tx, 42, true));
+    BOOST_REQUIRE(!cache.populate(out_tx, 43, true));
+
+    // Hits and queries are both initialized to one.
+    BOOST_REQUIRE_EQUAL(cache.hit_rate(), 2.0f / 3.0f);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_cache__add__shard_full__evicts_least_recently_used)
+{
+    transaction out_tx;
+    transaction_cache cache(shards * empty_tx_size * 2u);
+
+    // These links map to the same shard.
+    cache.add(0, empty_tx);
+    cache.add(shards, empty_tx);
+
+    // Promote the first entry, making the second least recently used.
+    BOOST_REQUIRE(cache.populate(out_tx, 0, true));
+
+    cache.add(shards * 2u, empty_tx);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE(cache.populate(out_tx, 0, true));
+    BOOST_REQUIRE(!cache.populate(out_tx, shards, true));
+    BOOST_REQUIRE(cache.populate(out_tx, shards * 2u, true));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
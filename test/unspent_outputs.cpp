@@ -19,6 +19,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <bitcoin/database.hpp>
+#include "utility/utility.hpp"
 
 using namespace bc;
 using namespace bc::database;
@@ -27,15 +28,18 @@ using namespace bc::system::chain;
 
 BOOST_AUTO_TEST_SUITE(unspent_outputs_tests)
 
+// Capacity is in bytes, divided among shards.
+static const size_t capacity = 1000000;
+
 BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_0__disabled)
 {
     const unspent_outputs cache(0);
     BOOST_REQUIRE(cache.disabled());
 }
 
-BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_42__not_disabled)
+BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity__not_disabled)
 {
-    const unspent_outputs cache(42);
+    const unspent_outputs cache(capacity);
     BOOST_REQUIRE(!cache.disabled());
 }
 
@@ -45,9 +49,9 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_0__size_0)
     BOOST_REQUIRE_EQUAL(cache.size(), 0u);
 }
 
-BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_42__empty)
+BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity__empty)
 {
-    const unspent_outputs cache(42);
+    const unspent_outputs cache(capacity);
     BOOST_REQUIRE(cache.empty());
 }
 
@@ -57,18 +61,27 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__hit_rate__default__1)
     BOOST_REQUIRE_EQUAL(cache.hit_rate(), 1.0f);
 }
 
-BOOST_AUTO_TEST_CASE(unspent_outputs__add__one_capacity_42__size_1)
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__one_capacity__size_1)
 {
     static const transaction tx{ 0, 0, input::list{}, output::list{ output{} } };
-    unspent_outputs cache(42);
+    unspent_outputs cache(capacity);
+    cache.add(tx, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__one_transaction_bytes_per_shard__size_1)
+{
+    static const script p2pkh{ script::to_pay_key_hash_pattern(null_short_hash) };
+    static const transaction tx{ 0, 0, input::list{}, output::list{ { 1, p2pkh }, { 2, p2pkh } } };
+    unspent_outputs cache(16 * unspent_outputs::transaction_bytes);
     cache.add(tx, 0, 0, false);
     BOOST_REQUIRE_EQUAL(cache.size(), 1u);
 }
 
-BOOST_AUTO_TEST_CASE(unspent_outputs__add__no_outputs_capcity_42__empty)
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__no_outputs_capacity__empty)
 {
     static const transaction tx{ 0, 0, {}, {} };
-    unspent_outputs cache(42);
+    unspent_outputs cache(capacity);
     cache.add(tx, 0, 0, false);
     BOOST_REQUIRE(cache.empty());
 }
@@ -84,7 +97,7 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__add__one_capcity_0__empty)
 BOOST_AUTO_TEST_CASE(unspent_outputs__remove1__remove_only__empty)
 {
     static const transaction tx{ 0, 0, {}, { {}, {} } };
-    unspent_outputs cache(1);
+    unspent_outputs cache(capacity);
     cache.add(tx, 0, 0, false);
     BOOST_REQUIRE_EQUAL(cache.size(), 1u);
 
@@ -114,7 +127,7 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__remove2__remove_one_output__expected_outpu
     static const uint32_t expected_median_time_past = 43;
     static const transaction tx1{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
     static const transaction tx2{ 0, 0, {}, { { 0, {} }, { expected_value, {} } } };
-    unspent_outputs cache(42);
+    unspent_outputs cache(capacity);
     cache.add(tx1, 0, 0, false);
     cache.add(tx2, expected_height, expected_median_time_past, expected_confirmed);
     BOOST_REQUIRE_EQUAL(cache.size(), 2u);
@@ -144,11 +157,11 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__remove2__remove_one_output__expected_outpu
     BOOST_REQUIRE(cache.populate({ tx2.hash(), 1 }, max_size_t));
 }
 
-BOOST_AUTO_TEST_CASE(unspent_outputs__get__two_capacity_1__size_1_expected)
+BOOST_AUTO_TEST_CASE(unspent_outputs__populate__two_outputs__expected)
 {
     static const size_t expected_height = 40;
     static const transaction tx1{ 0, 0, {}, { {}, {} } };
-    unspent_outputs cache(1);
+    unspent_outputs cache(capacity);
     cache.add(tx1, expected_height, 0, false);
     BOOST_REQUIRE_EQUAL(cache.size(), 1u);
 
@@ -163,7 +176,7 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__get__two_capacity_1__size_1_expected)
     BOOST_REQUIRE(tx2.is_valid());
 
     cache.add(tx2, 0, 0, false);
-    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
 
     chain::output_point point2a{ tx2.hash(), 1 };
     BOOST_REQUIRE(cache.populate(point2a, max_size_t));
@@ -176,4 +189,65 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__get__two_capacity_1__size_1_expected)
     BOOST_REQUIRE_EQUAL(point2b.metadata.cache.value(), expected2b);
 }
 
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__exceeds_shard_capacity__empty)
+{
+    static const transaction tx{ 0, 0, {}, { {}, {} } };
+    unspent_outputs cache(1);
+    BOOST_REQUIRE(!cache.disabled());
+
+    cache.add(tx, 0, 0, false);
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__over_capacity__evicts_retains_latest)
+{
+    static const size_t count = 1000;
+    unspent_outputs cache(16 * 1024);
+
+    for (uint32_t locktime = 0; locktime < count; ++locktime)
+    {
+        const transaction tx{ 0, locktime, {}, { { locktime, {} } } };
+        cache.add(tx, 0, 0, true);
+
+        // The most recent tx is never evicted by its own insertion.
+        BOOST_REQUIRE(cache.populate({ tx.hash(), 0 }, max_size_t));
+    }
+
+    BOOST_REQUIRE(!cache.empty());
+    BOOST_REQUIRE_LT(cache.size(), count);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__load__saved__confirmed_outputs)
+{
+    static const std::string directory = "unspent_outputs";
+    static const auto file = directory + "/output_cache";
+    static const hash_digest top{ { 42 } };
+    static const transaction tx1{ 0, 1, {}, { { 41, {} }, { 42, {} } } };
+    static const transaction tx2{ 0, 2, {}, { { 43, {} } } };
+    test::clear_path(directory);
+
+    unspent_outputs saved(capacity);
+    saved.add(tx1, 10, 11, true);
+    saved.add(tx2, 20, 21, false);
+    saved.remove({ tx1.hash(), 0 });
+    BOOST_REQUIRE(saved.save(file, top));
+
+    unspent_outputs stale(capacity);
+    BOOST_REQUIRE(!stale.load(file, null_hash));
+
+    unspent_outputs loaded(capacity);
+    BOOST_REQUIRE(loaded.load(file, top));
+    BOOST_REQUIRE_EQUAL(loaded.size(), 1u);
+    BOOST_REQUIRE(!loaded.populate({ tx1.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(!loaded.populate({ tx2.hash(), 0 }, max_size_t));
+
+    chain::output_point point{ tx1.hash(), 1 };
+    BOOST_REQUIRE(loaded.populate(point, max_size_t));
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 42u);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 10u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 11u);
+    BOOST_REQUIRE(point.metadata.confirmed);
+    test::clear_path(directory);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
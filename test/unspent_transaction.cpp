@@ -100,26 +100,63 @@ BOOST_AUTO_TEST_CASE(unspent_transaction__outputs__construct1__tx_hash__empty)
 {
     static const transaction tx;
     const auto expected = tx.hash();
-    BOOST_REQUIRE(unspent_transaction(expected).outputs()->empty());
+    BOOST_REQUIRE(unspent_transaction(expected).empty());
 }
 
 BOOST_AUTO_TEST_CASE(unspent_transaction__outputs__construct2__empty)
 {
     static const transaction tx;
     const output_point point{ tx.hash(), 42 };
-    BOOST_REQUIRE(unspent_transaction(point).outputs()->empty());
+    BOOST_REQUIRE(unspent_transaction(point).empty());
 }
 
 BOOST_AUTO_TEST_CASE(unspent_transaction__outputs__construct3_empty_tx__empty)
 {
     static const transaction tx;
-    BOOST_REQUIRE(unspent_transaction(tx, 0, 0, false).outputs()->empty());
+    BOOST_REQUIRE(unspent_transaction(tx, 0, 0, false).empty());
 }
 
 BOOST_AUTO_TEST_CASE(unspent_transaction__outputs__construct3_single_output_tx__one_output)
 {
     static const transaction tx{ 0, 0, {}, { {} } };
-    BOOST_REQUIRE_EQUAL(unspent_transaction(tx, 0, 0, false).outputs()->size(), 1u);
+    BOOST_REQUIRE_EQUAL(unspent_transaction(tx, 0, 0, false).size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_transaction__populate__outputs__expected)
+{
+    static const transaction tx{ 0, 0, {}, { { 41, script::to_pay_key_hash_pattern(null_short_hash) }, { 42, {} } } };
+    const unspent_transaction instance(tx, 0, 0, false);
+
+    output first;
+    BOOST_REQUIRE(instance.populate(first, 0));
+    BOOST_REQUIRE(first == tx.outputs()[0]);
+
+    output second;
+    BOOST_REQUIRE(instance.populate(second, 1));
+    BOOST_REQUIRE(second == tx.outputs()[1]);
+
+    output third;
+    BOOST_REQUIRE(!instance.populate(third, 2));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_transaction__spend__outputs__expected)
+{
+    static const transaction tx{ 0, 0, {}, { { 41, {} }, { 42, {} } } };
+    unspent_transaction instance(tx, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.bytes() != 0u);
+
+    output out;
+    BOOST_REQUIRE(instance.spend(1));
+    BOOST_REQUIRE(!instance.spend(1));
+    BOOST_REQUIRE(!instance.spend(2));
+    BOOST_REQUIRE(!instance.populate(out, 1));
+    BOOST_REQUIRE(instance.populate(out, 0));
+    BOOST_REQUIRE_EQUAL(out.value(), 41u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    BOOST_REQUIRE(instance.spend(0));
+    BOOST_REQUIRE(instance.empty());
 }
 
 BOOST_AUTO_TEST_CASE(unspent_transaction__equal__tx_hash_only__true)
@@ -150,4 +187,48 @@ BOOST_AUTO_TEST_CASE(unspent_transaction__copy_assign__coinbase_tx_hash_height__
     BOOST_REQUIRE_EQUAL(copied.is_coinbase(), true);
 }
 
+BOOST_AUTO_TEST_CASE(unspent_transaction__from_data__to_data__true)
+{
+    static const transaction tx{ 0, 0, {}, { { 42, script::to_pay_key_hash_pattern(null_short_hash) } } };
+    const unspent_transaction instance(tx, 42, 0, false);
+
+    data_chunk data;
+    data_sink ostream(data);
+    ostream_writer sink(ostream);
+    instance.to_data(sink);
+    ostream.flush();
+
+    data_source istream(data);
+    istream_reader source(istream);
+    unspent_transaction loaded(null_hash);
+    BOOST_REQUIRE(loaded.from_data(source));
+    BOOST_REQUIRE(loaded.hash() == tx.hash());
+    BOOST_REQUIRE_EQUAL(loaded.height(), 42u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_transaction__from_data__offset_beyond_outputs__false)
+{
+    static const transaction tx{ 0, 0, {}, { { 42, script::to_pay_key_hash_pattern(null_short_hash) } } };
+    const unspent_transaction instance(tx, 42, 0, false);
+
+    data_chunk data;
+    data_sink ostream(data);
+    ostream_writer sink(ostream);
+    instance.to_data(sink);
+    ostream.flush();
+
+    // The first offset follows the 54 byte header and 1 byte bitmap.
+    static const size_t offset = hash_size + 4 + 4 + 1 + 1 + 4 + 4 + 4 + 1;
+    BOOST_REQUIRE_GT(data.size(), offset + 4u);
+    data[offset + 0] = 0xff;
+    data[offset + 1] = 0xff;
+    data[offset + 2] = 0x00;
+    data[offset + 3] = 0x00;
+
+    data_source istream(data);
+    istream_reader source(istream);
+    unspent_transaction loaded(null_hash);
+    BOOST_REQUIRE(!loaded.from_data(source));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
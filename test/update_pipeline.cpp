@@ -0,0 +1,243 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "utility/utility.hpp"
+
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace bc::database;
+using namespace boost::filesystem;
+
+#define DIRECTORY "update_pipeline"
+
+#define MAINNET_BLOCK1                                                  \
+"010000006fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000982" \
+"051fd1e4ba744bbbe680e1fee14677ba1a3c3540bf7b1cdb606e857233e0e61bc6649ffff00" \
+"1d01e3629901010000000100000000000000000000000000000000000000000000000000000" \
+"00000000000ffffffff0704ffff001d0104ffffffff0100f2052a0100000043410496b538e8" \
+"53519c726a2c91e61ec11600ae1390813a627c66fb8be7947be63c52da7589379515d4e0a60" \
+"4f8141781e62294721166bf621e73a82cbf2342c858eeac00000000"
+
+#define MAINNET_BLOCK2                                                  \
+"010000004860eb18bf1b1620e37e9490fc8a427514416fd75159ab86688e9a8300000000d5f" \
+"dcc541e25de1c7a5addedf24858b8bb665c9f36ef744ee42c316022c90f9bb0bc6649ffff00" \
+"1d08d2bd6101010000000100000000000000000000000000000000000000000000000000000" \
+"00000000000ffffffff0704ffff001d010bffffffff0100f2052a010000004341047211a824" \
+"f55b505228e4c3d5194c1fcfaa15a456abdf37f9b9d97a4040afc073dee6c89064984f03385" \
+"237d92167c13e236446b417ab79a0fcae412ae3316b77ac00000000"
+
+static block_const_ptr read_block(const std::string hex)
+{
+    data_chunk data;
+    BOOST_REQUIRE(decode_base16(data, hex));
+    const auto result = std::make_shared<message::block>();
+    BOOST_REQUIRE(result->from_data(data));
+    return result;
+}
+
+struct update_pipeline_setup_fixture
+{
+    update_pipeline_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+
+    ~update_pipeline_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(update_pipeline_tests, update_pipeline_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(update_pipeline__enqueue__out_of_order__completed_in_order)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base instance(settings, false, false);
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    const auto incoming = std::make_shared<header_const_ptr_list>(
+        header_const_ptr_list
+        {
+            std::make_shared<const message::header>(block1->header()),
+            std::make_shared<const message::header>(block2->header())
+        });
+
+    const auto outgoing = std::make_shared<header_const_ptr_list>();
+    const config::checkpoint fork_point(bc_settings.genesis_block.hash(), 0);
+    BOOST_REQUIRE_EQUAL(instance.reorganize(fork_point, incoming, outgoing), error::success);
+
+    std::vector<size_t> heights;
+    std::vector<code> codes;
+
+    {
+        update_pipeline pipeline(instance, 1, 2, 10,
+            [&](const code& ec, block_const_ptr, size_t height)
+            {
+                codes.push_back(ec);
+                heights.push_back(height);
+            });
+
+        BOOST_REQUIRE(pipeline.enqueue(block2, 2));
+        BOOST_REQUIRE(pipeline.enqueue(block1, 1));
+        pipeline.stop();
+        BOOST_REQUIRE(!pipeline.enqueue(block1, 1));
+    }
+
+    BOOST_REQUIRE_EQUAL(heights.size(), 2u);
+    BOOST_REQUIRE_EQUAL(heights[0], 1u);
+    BOOST_REQUIRE_EQUAL(heights[1], 2u);
+    BOOST_REQUIRE_EQUAL(codes[0], error::success);
+    BOOST_REQUIRE_EQUAL(codes[1], error::success);
+    BOOST_REQUIRE_EQUAL(instance.blocks().get(2, true).transaction_count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(update_pipeline__enqueue__gap_beyond_limit__missing_height_failed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base instance(settings, false, false);
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    const auto incoming = std::make_shared<header_const_ptr_list>(
+        header_const_ptr_list
+        {
+            std::make_shared<const message::header>(block1->header()),
+            std::make_shared<const message::header>(block2->header())
+        });
+
+    const auto outgoing = std::make_shared<header_const_ptr_list>();
+    const config::checkpoint fork_point(bc_settings.genesis_block.hash(), 0);
+    BOOST_REQUIRE_EQUAL(instance.reorganize(fork_point, incoming, outgoing), error::success);
+
+    std::vector<size_t> heights;
+    std::vector<code> codes;
+    std::vector<block_const_ptr> blocks;
+
+    {
+        // No update may be held awaiting a missing height.
+        update_pipeline pipeline(instance, 1, 1, 0,
+            [&](const code& ec, block_const_ptr block, size_t height)
+            {
+                codes.push_back(ec);
+                blocks.push_back(block);
+                heights.push_back(height);
+            });
+
+        BOOST_REQUIRE(pipeline.enqueue(block2, 2));
+        pipeline.stop();
+    }
+
+    BOOST_REQUIRE_EQUAL(heights.size(), 2u);
+    BOOST_REQUIRE_EQUAL(heights[0], 1u);
+    BOOST_REQUIRE_EQUAL(heights[1], 2u);
+    BOOST_REQUIRE_EQUAL(codes[0], error::operation_failed);
+    BOOST_REQUIRE_EQUAL(codes[1], error::success);
+    BOOST_REQUIRE(!blocks[0]);
+    BOOST_REQUIRE(blocks[1] == block2);
+}
+
+BOOST_AUTO_TEST_CASE(update_pipeline__enqueue__late_height__late_update_failed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.payment_table_buckets = 42;
+
+    data_base instance(settings, false, false);
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    const auto incoming = std::make_shared<header_const_ptr_list>(
+        header_const_ptr_list
+        {
+            std::make_shared<const message::header>(block1->header()),
+            std::make_shared<const message::header>(block2->header())
+        });
+
+    const auto outgoing = std::make_shared<header_const_ptr_list>();
+    const config::checkpoint fork_point(bc_settings.genesis_block.hash(), 0);
+    BOOST_REQUIRE_EQUAL(instance.reorganize(fork_point, incoming, outgoing), error::success);
+
+    std::vector<size_t> heights;
+    std::vector<code> codes;
+    std::vector<block_const_ptr> blocks;
+
+    {
+        // Height 1 is failed before its update is released.
+        update_pipeline pipeline(instance, 1, 1, 0,
+            [&](const code& ec, block_const_ptr block, size_t height)
+            {
+                codes.push_back(ec);
+                blocks.push_back(block);
+                heights.push_back(height);
+            });
+
+        BOOST_REQUIRE(pipeline.enqueue(block2, 2));
+        BOOST_REQUIRE(pipeline.enqueue(block1, 1));
+        pipeline.stop();
+    }
+
+    BOOST_REQUIRE_EQUAL(heights.size(), 3u);
+    BOOST_REQUIRE_EQUAL(heights[0], 1u);
+    BOOST_REQUIRE_EQUAL(heights[1], 2u);
+    BOOST_REQUIRE_EQUAL(heights[2], 1u);
+    BOOST_REQUIRE_EQUAL(codes[0], error::operation_failed);
+    BOOST_REQUIRE_EQUAL(codes[1], error::success);
+    BOOST_REQUIRE_EQUAL(codes[2], error::operation_failed);
+    BOOST_REQUIRE(!blocks[0]);
+    BOOST_REQUIRE(blocks[2] == block1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
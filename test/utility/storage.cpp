@@ -131,4 +131,9 @@ memory_ptr storage::reserve(size_t size)
     return memory;
 }
 
+bool storage::preserve(const uint8_t*, size_t)
+{
+    return true;
+}
+
 } // namespace test
@@ -42,6 +42,7 @@ public:
     bc::database::memory_ptr access();
     bc::database::memory_ptr resize(size_t size);
     bc::database::memory_ptr reserve(size_t size);
+    bool preserve(const uint8_t* address, size_t size);
 
 private:
     bool closed_;
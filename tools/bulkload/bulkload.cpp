@@ -0,0 +1,639 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_BULKLOAD_USAGE \
+    "Usage: bulkload <store directory> <block directory> [threads]\n"
+#define BS_BULKLOAD_DIR_NEW \
+    "Failed to create directory %1% with error, '%2%'.\n"
+#define BS_BULKLOAD_OPEN_FAIL \
+    "Failed to create or open the store at %1%.\n"
+#define BS_BULKLOAD_SOURCE_FAIL \
+    "Failed to read block files from %1%.\n"
+#define BS_BULKLOAD_PARSE_FAIL \
+    "Failed to parse a block of %1%.\n"
+#define BS_BULKLOAD_WRITE_FAIL \
+    "Failed to write block at height %1% with error, '%2%'.\n"
+#define BS_BULKLOAD_ORPHANS \
+    "Ignored %1% blocks that do not connect to the chain.\n"
+#define BS_BULKLOAD_STALE \
+    "Ignored %1% blocks of stale branches.\n"
+#define BS_BULKLOAD_DIVERGED \
+    "Failed to choose between branches of equal length at height %1%.\n"
+#define BS_BULKLOAD_STAGE \
+    "%1$-8s %2$10d blocks %3$10.1f MB %4$9.2f s " \
+    "%5$10.1f blocks/s %6$8.1f MB/s\n"
+#define BS_BULKLOAD_TOTAL \
+    "Loaded %1% blocks to height %2% in %3$.2f s.\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace boost::filesystem;
+using namespace boost::system;
+using boost::format;
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::chrono::microseconds microseconds;
+
+// Blocks per header reorganization and per confirmation write.
+static constexpr size_t batch_size = 1000;
+
+// Source files parsed ahead of the (single threaded) ordering stage.
+static constexpr size_t files_ahead = 2;
+
+// Blocks queued for update ahead of the confirmation stage.
+static constexpr size_t blocks_ahead = 4 * batch_size;
+
+// Blocks by which one branch of a fork must lead before it is connected.
+static constexpr size_t fork_depth = 32;
+
+// Median time past window (see chain_state).
+static constexpr size_t median_time_past_interval = 11;
+
+// Block file framing, [magic:4][size:4][block] (blk*.dat).
+static constexpr uint32_t mainnet_magic = 0xd9b4bef9;
+static constexpr uint32_t testnet_magic = 0x0709110b;
+static constexpr uint32_t regtest_magic = 0xdab5bffa;
+
+// Cumulative time and volume of one stage of the load.
+class stage
+{
+public:
+    stage(const std::string& name)
+      : name_(name), blocks_(0), bytes_(0), elapsed_(0)
+    {
+    }
+
+    void add(size_t blocks, size_t bytes, microseconds elapsed)
+    {
+        blocks_ += blocks;
+        bytes_ += bytes;
+        elapsed_ += static_cast<uint64_t>(elapsed.count());
+    }
+
+    // Rates are of busy time, summed over the threads of the stage.
+    void report() const
+    {
+        const auto megabytes = bytes_.load() / 1000000.0;
+        const auto seconds = std::max(elapsed_.load() / 1000000.0, 1e-6);
+        std::cout << format(BS_BULKLOAD_STAGE) % name_ % blocks_.load() %
+            megabytes % seconds % (blocks_.load() / seconds) %
+            (megabytes / seconds);
+    }
+
+private:
+    const std::string name_;
+    std::atomic<size_t> blocks_;
+    std::atomic<size_t> bytes_;
+    std::atomic<uint64_t> elapsed_;
+};
+
+static microseconds since(clock_type::time_point start)
+{
+    return std::chrono::duration_cast<microseconds>(clock_type::now() - start);
+}
+
+// The parsed blocks of one source file, in file order.
+struct source
+{
+    bool ready;
+    bool valid;
+    size_t bytes;
+    block_const_ptr_list blocks;
+};
+
+static bool is_framed(uint32_t magic)
+{
+    return magic == mainnet_magic || magic == testnet_magic ||
+        magic == regtest_magic;
+}
+
+// Files are either magic framed (blk*.dat) or simply length prefixed.
+// A framed file ends at the first zero (preallocated) frame.
+static bool parse_file(const path& file, source& out, stage& read,
+    stage& parse)
+{
+    auto start = clock_type::now();
+    ifstream stream(file.string(), std::ios::binary);
+
+    if (!stream.good())
+        return false;
+
+    const data_chunk data((std::istreambuf_iterator<char>(stream)),
+        std::istreambuf_iterator<char>());
+
+    const auto read_elapsed = since(start);
+    start = clock_type::now();
+
+    constexpr auto word = sizeof(uint32_t);
+    const auto framed = data.size() >= word &&
+        is_framed(from_little_endian_unsafe<uint32_t>(data.begin()));
+
+    size_t position = 0;
+    out.bytes = 0;
+
+    while (position + (framed ? 2 : 1) * word <= data.size())
+    {
+        const auto it = data.begin() + position;
+
+        if (framed && !is_framed(from_little_endian_unsafe<uint32_t>(it)))
+            break;
+
+        position += framed ? word : 0;
+        const auto size = from_little_endian_unsafe<uint32_t>(
+            data.begin() + position);
+        position += word;
+
+        if (size == 0 || position + size > data.size())
+            break;
+
+        const auto block = std::make_shared<message::block>();
+        const data_chunk raw(data.begin() + position,
+            data.begin() + position + size);
+
+        if (!block->from_data(raw, true))
+            return false;
+
+        out.blocks.push_back(block);
+        out.bytes += size;
+        position += size;
+    }
+
+    parse.add(out.blocks.size(), out.bytes, since(start));
+    read.add(out.blocks.size(), data.size(), read_elapsed);
+    return true;
+}
+
+static uint32_t median_time_past(const std::deque<uint32_t>& timestamps)
+{
+    if (timestamps.empty())
+        return 0;
+
+    std::vector<uint32_t> sorted(timestamps.begin(), timestamps.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2];
+}
+
+// Load a directory of serialized blocks into a new or existing store.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << BS_BULKLOAD_USAGE;
+        return -1;
+    }
+
+    const path prefix(argv[1]);
+    const path directory(argv[2]);
+    const auto threads = argc > 3 ? std::max(std::stoul(argv[3]), 1ul) :
+        std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<path> files;
+    error_code result;
+
+    for (directory_iterator it(directory, result), end; !result && it != end;
+        it.increment(result))
+        if (is_regular_file(it->path()))
+            files.push_back(it->path());
+
+    if (result)
+    {
+        std::cerr << format(BS_BULKLOAD_SOURCE_FAIL) % directory;
+        return -1;
+    }
+
+    // Source files are numbered, so name order is archive order.
+    std::sort(files.begin(), files.end());
+
+    // Writes are not flushed, the store is flushed on close.
+    const auto catalog = false;
+    const auto neutrino_filter_support = false;
+    database::settings configuration(system::config::settings::mainnet);
+    configuration.directory = prefix;
+    configuration.flush_writes = false;
+    const system::settings bitcoin_configuration(
+        system::config::settings::mainnet);
+
+    data_base database(configuration, catalog, neutrino_filter_support);
+    const auto exists = boost::filesystem::exists(prefix);
+
+    if (!exists && !create_directories(prefix, result))
+    {
+        std::cerr << format(BS_BULKLOAD_DIR_NEW) % prefix % result.message();
+        return -1;
+    }
+
+    if (!(exists ? database.open() :
+        database.create(bitcoin_configuration.genesis_block)))
+    {
+        std::cerr << format(BS_BULKLOAD_OPEN_FAIL) % prefix;
+        return -1;
+    }
+
+    // Resume from the confirmed top.
+    size_t top;
+    if (!database.blocks().top(top, false))
+    {
+        std::cerr << format(BS_BULKLOAD_OPEN_FAIL) % prefix;
+        return -1;
+    }
+
+    // Indexed header fields are read from memory.
+    block_database::index_entry entry;
+    std::deque<uint32_t> timestamps;
+
+    for (auto index = top - std::min(top, median_time_past_interval - 1);
+        index <= top; ++index)
+    {
+        if (!database.blocks().get(entry, index, false))
+        {
+            std::cerr << format(BS_BULKLOAD_OPEN_FAIL) % prefix;
+            return -1;
+        }
+
+        timestamps.push_back(entry.timestamp);
+    }
+
+    auto tip = entry.hash;
+
+    stage reading("read"), parsing("parse"), candidating("header"),
+        storing("store"), confirming("confirm");
+    const auto start = clock_type::now();
+
+    // Parse stage, files are parsed in parallel and ordered by consumption.
+    // ------------------------------------------------------------------------
+    std::vector<source> sources(files.size(), source{ false, false, 0, {} });
+    std::atomic<size_t> next_file(0);
+    std::atomic<bool> abandoned(false);
+    size_t consumed = 0;
+    std::mutex source_mutex;
+    std::condition_variable source_condition;
+
+    const auto parser = [&]()
+    {
+        size_t index;
+        while ((index = next_file++) < files.size() && !abandoned)
+        {
+            {
+                std::unique_lock<std::mutex> lock(source_mutex);
+                source_condition.wait(lock, [&]()
+                {
+                    return index < consumed + files_ahead + threads;
+                });
+            }
+
+            source parsed{ false, false, 0, {} };
+            parsed.valid = !abandoned &&
+                parse_file(files[index], parsed, reading, parsing);
+
+            {
+                std::unique_lock<std::mutex> lock(source_mutex);
+                parsed.ready = true;
+                sources[index] = std::move(parsed);
+            }
+
+            source_condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> parsers;
+    for (size_t thread = 0; thread < threads; ++thread)
+        parsers.emplace_back(parser);
+
+    // Store and confirm stages, txs are stored in parallel, then confirmed
+    // in height order in batches.
+    // ------------------------------------------------------------------------
+    hash_list confirmable;
+    std::atomic<bool> failed(false);
+    size_t outstanding = 0;
+    std::mutex outstanding_mutex;
+    std::condition_variable outstanding_condition;
+
+    const auto fail = [&](size_t height, const code& ec)
+    {
+        if (!failed.exchange(true))
+            std::cerr << format(BS_BULKLOAD_WRITE_FAIL) % height %
+                ec.message();
+    };
+
+    const auto confirm_batch = [&](size_t last_height)
+    {
+        if (confirmable.empty() || failed)
+            return;
+
+        const auto begin = clock_type::now();
+        const auto first_height = last_height - confirmable.size() + 1;
+        const auto ec = database.confirm(confirmable, first_height);
+
+        if (ec)
+            fail(first_height, ec);
+
+        confirming.add(confirmable.size(), 0, since(begin));
+        confirmable.clear();
+    };
+
+    // Invoked on one thread at a time, in height order.
+    const auto complete = [&](const code& ec, block_const_ptr block,
+        size_t height)
+    {
+        if (!failed && ec)
+            fail(height, ec);
+
+        if (!failed)
+        {
+            const auto bytes = block->serialized_size(true);
+            storing.add(1, bytes, std::chrono::duration_cast<microseconds>(
+                block->metadata.associate));
+
+            // The archive is trusted, so blocks are presumed valid.
+            const auto begin = clock_type::now();
+            const auto invalid = database.invalidate(block->header(),
+                error::success);
+
+            if (invalid)
+                fail(height, invalid);
+
+            confirming.add(0, bytes, since(begin));
+            confirmable.push_back(block->hash());
+
+            if (confirmable.size() == batch_size)
+                confirm_batch(height);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(outstanding_mutex);
+            --outstanding;
+        }
+
+        outstanding_condition.notify_one();
+    };
+
+    // Outstanding blocks are bounded, so the limit is reached only on a gap.
+    update_pipeline pipeline(database, top + 1, threads, blocks_ahead,
+        complete);
+
+    // Header stage, blocks are ordered by parent and candidated in batches.
+    // ------------------------------------------------------------------------
+    std::unordered_multimap<hash_digest, block_const_ptr> pending;
+    block_const_ptr_list batch;
+    header_const_ptr_list headers;
+    auto height = top;
+    auto fork_hash = tip;
+    auto fork_height = top;
+    auto parse_failed = false;
+    auto diverged = false;
+    size_t stale = 0;
+
+    const auto push_batch = [&]()
+    {
+        if (batch.empty() || failed)
+            return;
+
+        const auto begin = clock_type::now();
+        const auto incoming = std::make_shared<const header_const_ptr_list>(
+            std::move(headers));
+        const auto outgoing = std::make_shared<header_const_ptr_list>();
+        headers.clear();
+
+        const auto ec = database.reorganize(
+            config::checkpoint(fork_hash, fork_height), incoming, outgoing);
+
+        candidating.add(batch.size(), batch.size() *
+            chain::header::satoshi_fixed_size(), since(begin));
+
+        if (ec)
+        {
+            fail(fork_height + 1, ec);
+            return;
+        }
+
+        for (const auto& block: batch)
+        {
+            {
+                std::unique_lock<std::mutex> lock(outstanding_mutex);
+                outstanding_condition.wait(lock, [&]()
+                {
+                    return outstanding < blocks_ahead;
+                });
+
+                ++outstanding;
+            }
+
+            pipeline.enqueue(block, ++fork_height);
+        }
+
+        fork_hash = batch.back()->hash();
+        batch.clear();
+    };
+
+    const auto connect = [&](block_const_ptr block)
+    {
+        // The median time past is stored with the header.
+        const auto next = std::make_shared<message::header>(block->header());
+        next->metadata.median_time_past = median_time_past(timestamps);
+        next->metadata.exists = false;
+        headers.push_back(next);
+
+        timestamps.push_back(block->header().timestamp());
+        if (timestamps.size() > median_time_past_interval)
+            timestamps.pop_front();
+
+        tip = block->hash();
+        ++height;
+        batch.push_back(block);
+
+        if (batch.size() == batch_size)
+            push_batch();
+    };
+
+    // The length of the longest pending branch from the block, up to limit.
+    std::function<size_t(const hash_digest&, size_t)> depth =
+        [&](const hash_digest& hash, size_t limit)
+    {
+        size_t longest = 0;
+        const auto range = pending.equal_range(hash);
+
+        for (auto it = range.first; it != range.second && longest + 1 < limit;
+            ++it)
+            longest = std::max(longest, depth(it->second->hash(), limit - 1));
+
+        return longest + 1;
+    };
+
+    // Drop the pending children of the block and their descendants.
+    std::function<void(const hash_digest&)> discard =
+        [&](const hash_digest& hash)
+    {
+        const auto range = pending.equal_range(hash);
+        hash_list children;
+
+        for (auto it = range.first; it != range.second; ++it)
+            children.push_back(it->second->hash());
+
+        pending.erase(range.first, range.second);
+        stale += children.size();
+
+        for (const auto& child: children)
+            discard(child);
+    };
+
+    // Connect children of the tip while one branch leads its siblings by the
+    // fork depth. Once input is exhausted any lead suffices, false on a tie.
+    const auto advance = [&](bool exhausted)
+    {
+        const auto limit = exhausted ? max_size_t : 2 * fork_depth;
+
+        while (!failed)
+        {
+            const auto range = pending.equal_range(tip);
+
+            if (range.first == range.second)
+                return true;
+
+            auto best = range.first;
+            size_t best_depth = 0;
+            size_t next_depth = 0;
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const auto length = depth(it->second->hash(), limit);
+
+                if (length > best_depth)
+                {
+                    next_depth = best_depth;
+                    best_depth = length;
+                    best = it;
+                }
+                else
+                {
+                    next_depth = std::max(next_depth, length);
+                }
+            }
+
+            const auto lead = best_depth - next_depth;
+
+            if (lead == 0 || (!exhausted && lead < fork_depth))
+                return !exhausted;
+
+            const auto block = best->second;
+            pending.erase(best);
+            discard(tip);
+            connect(block);
+        }
+
+        return true;
+    };
+
+    for (size_t index = 0; index < files.size() && !failed; ++index)
+    {
+        source current{ false, false, 0, {} };
+
+        {
+            std::unique_lock<std::mutex> lock(source_mutex);
+            source_condition.wait(lock, [&]()
+            {
+                return sources[index].ready;
+            });
+
+            current = std::move(sources[index]);
+            ++consumed;
+        }
+
+        source_condition.notify_all();
+
+        if (!current.valid)
+        {
+            std::cerr << format(BS_BULKLOAD_PARSE_FAIL) % files[index];
+            parse_failed = true;
+            break;
+        }
+
+        // Archives are not strictly ordered and may hold stale branches.
+        for (const auto& block: current.blocks)
+        {
+            // Archives may hold blocks already in the store (genesis).
+            if (!database.blocks().get(block->hash()))
+                pending.emplace(block->header().previous_block_hash(), block);
+        }
+
+        advance(false);
+    }
+
+    if (!parse_failed && !advance(true))
+    {
+        std::cerr << format(BS_BULKLOAD_DIVERGED) % (height + 1);
+        diverged = true;
+    }
+
+    push_batch();
+
+    // Stop the parsers, including any waiting to parse ahead.
+    {
+        std::unique_lock<std::mutex> lock(source_mutex);
+        abandoned = true;
+        consumed = files.size();
+    }
+
+    source_condition.notify_all();
+
+    for (auto& thread: parsers)
+        thread.join();
+
+    pipeline.stop();
+    confirm_batch(height);
+
+    const auto elapsed = since(start);
+    reading.report();
+    parsing.report();
+    candidating.report();
+    storing.report();
+    confirming.report();
+
+    if (stale != 0)
+        std::cout << format(BS_BULKLOAD_STALE) % stale;
+
+    if (!pending.empty())
+        std::cout << format(BS_BULKLOAD_ORPHANS) % pending.size();
+
+    std::cout << format(BS_BULKLOAD_TOTAL) % (height - top) % height %
+        (elapsed.count() / 1000000.0);
+
+    const auto closed = database.close();
+    return !parse_failed && !diverged && !failed && closed ? 0 : -1;
+}
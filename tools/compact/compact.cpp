@@ -0,0 +1,369 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_COMPACT_USAGE \
+    "Usage: compact <source directory> <destination directory> [threads]\n"
+#define BS_COMPACT_DIR_EXISTS \
+    "Failed because the directory %1% already exists.\n"
+#define BS_COMPACT_DIR_NEW \
+    "Failed to create directory %1% with error, '%2%'.\n"
+#define BS_COMPACT_OPEN_FAIL \
+    "Failed to open the store at %1%.\n"
+#define BS_COMPACT_COPY_FAIL \
+    "Failed to copy %1% with error, '%2%'.\n"
+#define BS_COMPACT_CREATE_FAIL \
+    "Failed to create the transaction table at %1%.\n"
+#define BS_COMPACT_RELOCATE_FAIL \
+    "Failed to relocate the transaction at %1%.\n"
+#define BS_COMPACT_CLOSE_FAIL \
+    "Failed to close the store at %1%.\n"
+#define BS_COMPACT_STAGE \
+    "%1$-8s %2$12d links %3$9.2f s\n"
+#define BS_COMPACT_TOTAL \
+    "Compacted %1% confirmed and %2% other transactions in %3$.2f s.\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace boost::filesystem;
+using namespace boost::system;
+using boost::format;
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::function<void(size_t first, size_t last)> range_work;
+
+// Confirmed heights per (parallel) read of block tx links.
+static constexpr size_t batch_size = 10000;
+
+static double seconds_since(clock_type::time_point start)
+{
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        clock_type::now() - start);
+    return elapsed.count() / 1000000.0;
+}
+
+// Split [0, count) into one contiguous range per thread and wait on all.
+static void parallel(size_t count, size_t threads, const range_work& work)
+{
+    const auto range = std::max((count + threads - 1) / threads, size_t(1));
+    std::vector<std::thread> workers;
+
+    for (size_t first = 0; first < count; first += range)
+        workers.emplace_back(work, first, std::min(first + range, count));
+
+    for (auto& worker: workers)
+        worker.join();
+}
+
+// Write one byte so file is nonzero size (for memory map validation).
+static bool create_file(const path& file_path)
+{
+    system::ofstream file(file_path.string());
+
+    if (!file.good())
+        return false;
+
+    file.put('x');
+    return true;
+}
+
+static bool copy_table(const path& from, const path& to)
+{
+    error_code ec;
+    copy_file(from, to, copy_option::overwrite_if_exists, ec);
+
+    if (ec)
+        std::cerr << format(BS_COMPACT_COPY_FAIL) % from % ec.message();
+
+    return !ec;
+}
+
+// Rewrite the transaction table of a store in confirmed height and position
+// order, so that reading consecutive blocks reads the table sequentially.
+// Txs referenced only by unconfirmed blocks or payment rows follow, and txs
+// referenced by neither (unconfirmed pool txs) are dropped. The source tables
+// are not modified. The hash table is rebuilt in the course of the copy, the
+// tx index and payment rows are copied and their tx links replaced.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << BS_COMPACT_USAGE;
+        return -1;
+    }
+
+    const path source_prefix(argv[1]);
+    const path prefix(argv[2]);
+    const auto threads = argc > 3 ? std::max(std::stoul(argv[3]), 1ul) :
+        std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (exists(prefix))
+    {
+        std::cerr << format(BS_COMPACT_DIR_EXISTS) % prefix;
+        return -1;
+    }
+
+    error_code result;
+    if (!create_directories(prefix, result))
+    {
+        std::cerr << format(BS_COMPACT_DIR_NEW) % prefix % result.message();
+        return -1;
+    }
+
+    // The store must have been created with the mainnet table configuration.
+    database::settings configuration(system::config::settings::mainnet);
+    configuration.directory = source_prefix;
+    configuration.flush_writes = false;
+
+    const auto catalog = exists(source_prefix / store::PAYMENT_TABLE);
+    const auto filter = exists(source_prefix / store::NEUTRINO_FILTER_TABLE);
+    data_base source(configuration, catalog, filter);
+
+    // The destination tables, named as in the source.
+    const auto block_table = prefix / store::BLOCK_TABLE;
+    const auto candidate_index = prefix / store::CANDIDATE_INDEX;
+    const auto confirmed_index = prefix / store::CONFIRMED_INDEX;
+    const auto transaction_index = prefix / store::TRANSACTION_INDEX;
+    const auto transaction_table = prefix / store::TRANSACTION_TABLE;
+    const auto witness_table = prefix / store::WITNESS_TABLE;
+    const auto utxo_table = prefix / store::UTXO_TABLE;
+    const auto neutrino_filter_table = prefix / store::NEUTRINO_FILTER_TABLE;
+    const auto payment_table = prefix / store::PAYMENT_TABLE;
+    const auto payment_rows = prefix / store::PAYMENT_ROWS;
+
+    if (!source.open())
+    {
+        std::cerr << format(BS_COMPACT_OPEN_FAIL) % source_prefix;
+        return -1;
+    }
+
+    // Tables without tx links are copied as is, those with are then updated.
+    const auto copied =
+        copy_table(source.block_table, block_table) &&
+        copy_table(source.candidate_index, candidate_index) &&
+        copy_table(source.confirmed_index, confirmed_index) &&
+        copy_table(source.transaction_index, transaction_index) &&
+        (!filter || copy_table(source.neutrino_filter_table,
+            neutrino_filter_table)) &&
+        (!catalog || copy_table(source.payment_table, payment_table)) &&
+        (!catalog || copy_table(source.payment_rows, payment_rows));
+
+    if (!copied)
+        return -1;
+
+    // The utxo table is keyed by point and holds no tx links. A minimal table
+    // is created here, to be replaced with a copy of the source on close.
+    transaction_database transactions(transaction_table,
+        witness_table, utxo_table,
+        configuration.transaction_table_size,
+        configuration.witness_table_size, 1,
+        configuration.transaction_table_buckets, 0,
+        configuration.file_growth_rate, 0, 0);
+
+    block_database blocks(block_table, candidate_index,
+        confirmed_index, transaction_index,
+        configuration.block_table_size, configuration.candidate_index_size,
+        configuration.confirmed_index_size,
+        configuration.transaction_index_size,
+        configuration.block_table_buckets, configuration.file_growth_rate,
+        filter);
+
+    payment_database payments(payment_table, payment_rows,
+        configuration.payment_table_size, configuration.payment_index_size,
+        configuration.payment_table_buckets, configuration.file_growth_rate);
+
+    if (!create_file(transaction_table) ||
+        !create_file(witness_table) ||
+        !create_file(utxo_table) || !transactions.create())
+    {
+        std::cerr << format(BS_COMPACT_CREATE_FAIL) % prefix;
+        return -1;
+    }
+
+    if (!blocks.open() || (catalog && !payments.open()))
+    {
+        std::cerr << format(BS_COMPACT_OPEN_FAIL) % prefix;
+        return -1;
+    }
+
+    const auto start = clock_type::now();
+    const auto& source_blocks = source.blocks();
+    const auto& source_transactions = source.transactions();
+    std::atomic<bool> failed(false);
+
+    const auto fail = [&](file_offset link)
+    {
+        if (!failed.exchange(true))
+            std::cerr << format(BS_COMPACT_RELOCATE_FAIL) % link;
+    };
+
+    // Confirmed stage, block tx links are read in parallel by height range,
+    // and the txs are then copied in height and position order.
+    // ------------------------------------------------------------------------
+    size_t top;
+    auto stage_start = clock_type::now();
+    size_t confirmed = 0;
+
+    if (!source_blocks.top(top, false))
+    {
+        std::cerr << format(BS_COMPACT_OPEN_FAIL) % source_prefix;
+        return -1;
+    }
+
+    for (size_t first = 0; first <= top && !failed; first += batch_size)
+    {
+        const auto count = std::min(batch_size, top + 1 - first);
+        std::vector<link_list> batch(count);
+
+        parallel(count, threads, [&](size_t begin, size_t end)
+        {
+            for (auto index = begin; index < end; ++index)
+            {
+                const auto block = source_blocks.get(first + index, false);
+                auto& links = batch[index];
+                links.reserve(block.transaction_count());
+
+                for (const auto link: block)
+                    links.push_back(link);
+            }
+        });
+
+        for (const auto& links: batch)
+        {
+            for (const auto link: links)
+            {
+                file_offset copy;
+                if (!transactions.relocate(copy, source_transactions, link))
+                    fail(link);
+            }
+
+            confirmed += links.size();
+        }
+    }
+
+    std::cout << format(BS_COMPACT_STAGE) % "confirm" % confirmed %
+        seconds_since(stage_start);
+
+    // Link stage, tx index and payment rows are updated in parallel ranges.
+    // A tx not yet copied (not confirmed) is copied on first reference.
+    // ------------------------------------------------------------------------
+    std::mutex relocate_mutex;
+    std::atomic<size_t> others(0);
+
+    const relocator relocate = [&](file_offset link) -> file_offset
+    {
+        const auto result = source_transactions.get(link);
+
+        if (!result)
+        {
+            fail(link);
+            return link;
+        }
+
+        const auto hash = result.hash();
+        const auto existing = transactions.get(hash);
+
+        if (existing)
+            return existing.link();
+
+        file_offset copy = link;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        relocate_mutex.lock();
+
+        // Another thread may have copied the tx since the above test.
+        const auto copied = transactions.get(hash);
+        const auto relocated = copied ? copied.link() :
+            transactions.relocate(copy, source_transactions, link) ? copy :
+            link;
+
+        relocate_mutex.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        if (relocated == link)
+            fail(link);
+        else if (!copied)
+            ++others;
+
+        return relocated;
+    };
+
+    stage_start = clock_type::now();
+    const auto links = blocks.transaction_links();
+
+    if (!failed)
+        parallel(links, threads, [&](size_t first, size_t last)
+        {
+            blocks.relocate(relocate, first, last);
+        });
+
+    std::cout << format(BS_COMPACT_STAGE) % "index" % links %
+        seconds_since(stage_start);
+
+    stage_start = clock_type::now();
+    const auto rows = catalog ? payments.payment_rows() : 0;
+
+    if (!failed && catalog)
+        parallel(rows, threads, [&](size_t first, size_t last)
+        {
+            payments.relocate(relocate, first, last);
+        });
+
+    std::cout << format(BS_COMPACT_STAGE) % "payment" % rows %
+        seconds_since(stage_start);
+
+    // Close, and replace the utxo table with the source copy.
+    // ------------------------------------------------------------------------
+    transactions.commit();
+    payments.commit();
+
+    const auto closed =
+        transactions.flush() && transactions.close() &&
+        blocks.flush() && blocks.close() &&
+        (!catalog || (payments.flush() && payments.close())) &&
+        copy_table(source.utxo_table, utxo_table) &&
+        source.close();
+
+    if (!closed)
+    {
+        std::cerr << format(BS_COMPACT_CLOSE_FAIL) % prefix;
+        return -1;
+    }
+
+    if (failed)
+        return -1;
+
+    std::cout << format(BS_COMPACT_TOTAL) % confirmed % others.load() %
+        seconds_since(start);
+    return 0;
+}